@@ -0,0 +1,161 @@
+// Статистика по записанным партиям в колоночном хранилище:
+//   sea_stats --store stats --ingest games.sea --watch 2
+//   sea_stats --store stats --query placement --size 10 --mines off
+//   sea_stats --store stats --query lengths --size 10 --mines on
+#include "analyticsstore.h"
+#include "gamerecord.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <thread>
+
+namespace {
+
+void printUsage() {
+    std::printf("usage: sea_stats --store dir --ingest games.sea [--watch seconds]\n"
+                "       sea_stats --store dir --query summary|info|compact\n"
+                "       sea_stats --store dir --query placement|shots|lengths [--size 8|10|12]\n"
+                "                 [--mines on|off|any] [--moves N] [--threads N]\n");
+}
+
+bool readFile(const std::string& path, std::vector<uint64_t>& data, size_t& size) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) return false;
+    size = size_t(in.tellg());
+    data.assign((size + 7) / 8, 0);
+    in.seekg(0);
+    in.read(reinterpret_cast<char *>(data.data()), std::streamsize(size));
+    return bool(in);
+}
+
+// Одна порция: новые партии архива - новым сегментом
+int ingest(AnalyticsStore& store, const std::string& path, bool quiet) {
+    std::vector<uint64_t> data;
+    size_t size = 0;
+    GameArchive archive;
+    if (!readFile(path, data, size) || !archive.attach(data.data(), size)) {
+        if (!quiet) std::fprintf(stderr, "%s: not a game archive\n", path.c_str());
+        return -1;
+    }
+    auto start = std::chrono::steady_clock::now();
+    size_t added = store.ingestArchive(archive, path);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (added || !quiet) std::printf("%zu new games from %s in %.3f s\n", added, path.c_str(), seconds);
+    return int(added);
+}
+
+void printGrid(int n, const std::vector<double>& values, double scale) {
+    std::printf("   ");
+    for (int x = 0; x < n; ++x) std::printf(" %4c", 'A' + x);
+    std::printf("\n");
+    for (int y = 0; y < n; ++y) {
+        std::printf("%3d", y + 1);
+        for (int x = 0; x < n; ++x) std::printf(" %4.0f", values[size_t(y * n + x)] * scale);
+        std::printf("\n");
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    std::string storePath = "stats";
+    std::string archivePath;
+    std::string query;
+    AnalyticsFilter filter;
+    int watchSeconds = 0;
+    int maxMove = 0;
+    unsigned threads = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || i + 1 >= argc) {
+            printUsage();
+            return arg == "--help" ? 0 : 1;
+        }
+        std::string value = argv[++i];
+        if (arg == "--store") storePath = value;
+        else if (arg == "--ingest") archivePath = value;
+        else if (arg == "--watch") watchSeconds = std::atoi(value.c_str());
+        else if (arg == "--query") query = value;
+        else if (arg == "--size") filter.gridSize = std::atoi(value.c_str());
+        else if (arg == "--mines" && (value == "on" || value == "off" || value == "any"))
+            filter.mines = value == "on" ? 1 : value == "off" ? 0 : -1;
+        else if (arg == "--moves") maxMove = std::atoi(value.c_str());
+        else if (arg == "--threads") threads = unsigned(std::atoi(value.c_str()));
+        else {
+            std::fprintf(stderr, "bad argument: %s %s\n", arg.c_str(), value.c_str());
+            printUsage();
+            return 1;
+        }
+    }
+
+    if (filter.gridSize != 8 && filter.gridSize != 10 && filter.gridSize != 12) {
+        std::fprintf(stderr, "size must be 8, 10 or 12\n");
+        return 1;
+    }
+
+    AnalyticsStore store(storePath, threads);
+
+    if (!archivePath.empty()) {
+        if (ingest(store, archivePath, false) < 0) return 1;
+        // Слежение за архивом игры: новые партии попадают в запросы через watch секунд
+        while (watchSeconds > 0) {
+            std::this_thread::sleep_for(std::chrono::seconds(watchSeconds));
+            if (ingest(store, archivePath, true) > 0 && store.segmentFiles().size() > 32) store.compact();
+        }
+        return 0;
+    }
+
+    const int n = filter.gridSize;
+    auto start = std::chrono::steady_clock::now();
+    if (query == "info") {
+        StoreInfo info = store.info();
+        std::printf("%zu segments, %llu games, %llu boards, %llu shots\n", info.segments,
+                    (unsigned long long)info.rows[0], (unsigned long long)info.rows[1],
+                    (unsigned long long)info.rows[2]);
+        std::printf("%llu bytes on disk, %llu bytes uncompressed (%.1fx)\n", (unsigned long long)info.bytes,
+                    (unsigned long long)info.rawBytes, info.bytes ? double(info.rawBytes) / info.bytes : 0.0);
+    } else if (query == "compact") {
+        if (!store.compact()) {
+            std::fprintf(stderr, "compaction failed\n");
+            return 1;
+        }
+        std::printf("%zu segments\n", store.segmentFiles().size());
+    } else if (query == "summary") {
+        std::printf("size mines    games finished first-win avg-shots\n");
+        for (const auto& s : store.summary()) {
+            std::printf("%2dx%-2d %-4s %8llu %8llu %8.1f%% %9.2f\n", s.gridSize, s.gridSize, s.mines ? "on" : "off",
+                        (unsigned long long)s.games, (unsigned long long)s.finished,
+                        s.finished ? 100.0 * s.firstPlayerWins / s.finished : 0.0,
+                        s.finished ? double(s.shots) / s.finished : 0.0);
+        }
+    } else if (query == "placement") {
+        std::printf("ship frequency per cell, %%\n");
+        printGrid(n, store.placementHeatMap(filter), 100);
+    } else if (query == "shots") {
+        std::vector<uint64_t> counts = store.shotHeatMap(filter, maxMove);
+        uint64_t total = 0;
+        for (uint64_t c : counts) total += c;
+        std::vector<double> share(counts.begin(), counts.end());
+        std::printf("shots per cell, per mille of %llu shots\n", (unsigned long long)total);
+        printGrid(n, share, total ? 1000.0 / double(total) : 0.0);
+    } else if (query == "lengths") {
+        std::vector<uint64_t> histogram = store.shotCountHistogram(filter);
+        uint64_t games = 0, shots = 0;
+        for (size_t s = 0; s < histogram.size(); ++s) {
+            games += histogram[s];
+            shots += histogram[s] * s;
+            if (histogram[s]) std::printf("%3zu %llu\n", s, (unsigned long long)histogram[s]);
+        }
+        std::printf("finished games: %llu, average shots: %.2f\n", (unsigned long long)games,
+                    games ? double(shots) / games : 0.0);
+    } else {
+        printUsage();
+        return 1;
+    }
+    std::printf("query took %.3f s\n",
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    return 0;
+}
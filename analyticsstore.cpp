@@ -0,0 +1,670 @@
+#include "analyticsstore.h"
+#include "workstealingpool.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const char SEGMENT_MAGIC[8] = {'S', 'E', 'A', 'C', 'O', 'L', 0, 0};
+const char *SOURCES_FILE = "sources";
+// Столько строк выстрелов копится в буфере до записи сегмента
+const size_t SEGMENT_SHOT_ROWS = 16 * ANALYTICS_GROUP_ROWS;
+
+// Набор колонок каждой таблицы в порядке записи
+const std::vector<AnalyticsColumn>& tableColumns(int table) {
+    static const std::vector<AnalyticsColumn> columns[3] = {
+        {ColGridSize, ColMines, ColWinner, ColFirstPlayer, ColShotCount, ColShots0, ColShots1, ColStartTime},
+        {ColGridSize, ColMines, ColSide, ColMask0, ColMask1, ColMask2},
+        {ColGridSize, ColMines, ColGame, ColMove, ColPlayer, ColCell, ColKind, ColSunk}};
+    return columns[table];
+}
+
+int bitsFor(uint64_t value) {
+    return value ? 64 - __builtin_clzll(value) : 0;
+}
+
+size_t varintSize(uint64_t value) {
+    size_t size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        ++size;
+    }
+    return size;
+}
+
+void putVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(uint8_t(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(uint8_t(value));
+}
+
+bool getVarint(const uint8_t *&p, const uint8_t *end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+        uint8_t byte = *p++;
+        value |= uint64_t(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+uint64_t zigzag(uint64_t delta) {
+    return (delta << 1) ^ uint64_t(int64_t(delta) >> 63);
+}
+
+uint64_t unzigzag(uint64_t value) {
+    return (value >> 1) ^ (0 - (value & 1));
+}
+
+// Сжимает колонку самым коротким из трёх способов
+ColumnEntry encodeColumn(AnalyticsColumn column, const uint64_t *values, size_t count,
+                         std::vector<uint8_t>& out) {
+    ColumnEntry entry{};
+    entry.column = column;
+    if (count == 0) return entry;
+
+    auto range = std::minmax_element(values, values + count);
+    entry.minValue = *range.first;
+    entry.maxValue = *range.second;
+    const int width = bitsFor(entry.maxValue - entry.minValue);
+
+    size_t packedSize = (count * size_t(width) + 7) / 8;
+    size_t rleSize = 0, deltaSize = 0;
+    uint64_t prev = entry.minValue;
+    for (size_t i = 0; i < count; ) {
+        size_t run = 1;
+        while (i + run < count && values[i + run] == values[i]) ++run;
+        rleSize += varintSize(values[i] - entry.minValue) + varintSize(run);
+        i += run;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        deltaSize += varintSize(zigzag(values[i] - prev));
+        prev = values[i];
+    }
+
+    const size_t start = out.size();
+    if (packedSize <= rleSize && packedSize <= deltaSize) {
+        entry.codec = uint8_t(ColumnCodec::BitPack);
+        entry.bitWidth = uint8_t(width);
+        out.resize(start + packedSize, 0);
+        uint8_t *data = out.data() + start;
+        size_t bit = 0;
+        for (size_t i = 0; i < count; ++i) {
+            uint64_t v = values[i] - entry.minValue;
+            for (int left = width; left > 0; ) {
+                int offset = int(bit & 7);
+                int take = std::min(8 - offset, left);
+                data[bit >> 3] |= uint8_t((v & ((1u << take) - 1)) << offset);
+                v >>= take;
+                bit += size_t(take);
+                left -= take;
+            }
+        }
+    } else if (rleSize <= deltaSize) {
+        entry.codec = uint8_t(ColumnCodec::Rle);
+        for (size_t i = 0; i < count; ) {
+            size_t run = 1;
+            while (i + run < count && values[i + run] == values[i]) ++run;
+            putVarint(out, values[i] - entry.minValue);
+            putVarint(out, run);
+            i += run;
+        }
+    } else {
+        entry.codec = uint8_t(ColumnCodec::DeltaVarint);
+        prev = entry.minValue;
+        for (size_t i = 0; i < count; ++i) {
+            putVarint(out, zigzag(values[i] - prev));
+            prev = values[i];
+        }
+    }
+    entry.byteSize = uint32_t(out.size() - start);
+    return entry;
+}
+
+bool decodeColumn(const ColumnEntry& entry, const uint8_t *data, size_t count, std::vector<uint64_t>& values) {
+    values.resize(count);
+    const uint8_t *end = data + entry.byteSize;
+    switch (ColumnCodec(entry.codec)) {
+    case ColumnCodec::BitPack: {
+        const int width = entry.bitWidth;
+        if (width > 64 || (count * size_t(width) + 7) / 8 > entry.byteSize) return false;
+        const uint64_t mask = width == 64 ? ~uint64_t(0) : (uint64_t(1) << width) - 1;
+        size_t bit = 0;
+        for (size_t i = 0; i < count; ++i, bit += size_t(width)) {
+            // Быстрый путь: значение целиком в 8 байтах от начального
+            const size_t byte = bit >> 3;
+            const int offset = int(bit & 7);
+            uint64_t v;
+            if (width + offset <= 64 && byte + 8 <= entry.byteSize) {
+                std::memcpy(&v, data + byte, 8);
+                v >>= offset;
+            } else {
+                v = 0;
+                for (int got = 0, pos = 0; got < width; ++pos) {
+                    const int o = pos == 0 ? offset : 0;
+                    v |= uint64_t(data[byte + size_t(pos)] >> o) << got;
+                    got += 8 - o;
+                }
+            }
+            values[i] = (v & mask) + entry.minValue;
+        }
+        return true;
+    }
+    case ColumnCodec::Rle: {
+        size_t i = 0;
+        while (i < count) {
+            uint64_t value, run;
+            if (!getVarint(data, end, value) || !getVarint(data, end, run) || run > count - i) return false;
+            std::fill_n(values.begin() + std::ptrdiff_t(i), run, value + entry.minValue);
+            i += run;
+        }
+        return true;
+    }
+    case ColumnCodec::DeltaVarint: {
+        uint64_t prev = entry.minValue;
+        for (size_t i = 0; i < count; ++i) {
+            uint64_t delta;
+            if (!getVarint(data, end, delta)) return false;
+            prev += unzigzag(delta);
+            values[i] = prev;
+        }
+        return true;
+    }
+    }
+    return false;
+}
+
+// Сегмент, прочитанный в память целиком; группы проверены при загрузке
+struct Segment {
+    std::vector<uint64_t> storage;
+    size_t size = 0;
+    SegmentHeader header{};
+
+    const uint8_t *bytes() const { return reinterpret_cast<const uint8_t *>(storage.data()); }
+
+    const GroupEntry& group(uint32_t g) const {
+        return reinterpret_cast<const GroupEntry *>(bytes() + sizeof(SegmentHeader))[g];
+    }
+
+    const ColumnEntry *columns(const GroupEntry& group) const {
+        return reinterpret_cast<const ColumnEntry *>(bytes() + group.offset);
+    }
+};
+
+std::unique_ptr<Segment> loadSegment(const std::string& path) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) return nullptr;
+    auto s = std::make_unique<Segment>();
+    s->size = size_t(in.tellg());
+    s->storage.assign((s->size + 7) / 8, 0);
+    in.seekg(0);
+    in.read(reinterpret_cast<char *>(s->storage.data()), std::streamsize(s->size));
+    if (!in || s->size < sizeof(SegmentHeader)) return nullptr;
+
+    std::memcpy(&s->header, s->bytes(), sizeof(SegmentHeader));
+    if (std::memcmp(s->header.magic, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC)) != 0 ||
+        s->header.version != ANALYTICS_VERSION ||
+        sizeof(SegmentHeader) + size_t(s->header.groupCount) * sizeof(GroupEntry) > s->size)
+        return nullptr;
+
+    for (uint32_t g = 0; g < s->header.groupCount; ++g) {
+        const GroupEntry& group = s->group(g);
+        if (group.table > 2 || group.offset % 8 != 0 ||
+            group.offset + size_t(group.columnCount) * sizeof(ColumnEntry) > s->size)
+            return nullptr;
+        size_t data = group.offset + size_t(group.columnCount) * sizeof(ColumnEntry);
+        const ColumnEntry *columns = s->columns(group);
+        for (int c = 0; c < group.columnCount; ++c) {
+            if (columns[c].column >= ColumnCount) return nullptr;
+            data += columns[c].byteSize;
+        }
+        if (data > s->size) return nullptr;
+    }
+    return s;
+}
+
+std::vector<std::unique_ptr<Segment>> loadSegments(const std::vector<std::string>& files) {
+    std::vector<std::unique_ptr<Segment>> segments;
+    for (const auto& path : files) {
+        auto s = loadSegment(path);
+        if (s) segments.push_back(std::move(s));
+        else std::fprintf(stderr, "%s: damaged segment skipped\n", path.c_str());
+    }
+    return segments;
+}
+
+// Распакованные колонки одной группы строк
+struct GroupView {
+    size_t rows = 0;
+    const std::vector<uint64_t> *columns[ColumnCount] = {};
+    const std::vector<uint64_t>& operator[](AnalyticsColumn c) const { return *columns[c]; }
+};
+
+// Колонка группы без распаковки: для отбора по min/max
+const ColumnEntry *findColumn(const Segment& s, const GroupEntry& group, AnalyticsColumn column) {
+    const ColumnEntry *columns = s.columns(group);
+    for (int c = 0; c < group.columnCount; ++c)
+        if (columns[c].column == column) return &columns[c];
+    return nullptr;
+}
+
+bool groupMayMatch(const Segment& s, const GroupEntry& group, const AnalyticsFilter *filter) {
+    if (!filter) return true;
+    const ColumnEntry *size = findColumn(s, group, ColGridSize);
+    const ColumnEntry *mines = findColumn(s, group, ColMines);
+    if (!size || uint64_t(filter->gridSize) < size->minValue || uint64_t(filter->gridSize) > size->maxValue)
+        return false;
+    if (filter->mines >= 0 && mines &&
+        (uint64_t(filter->mines) < mines->minValue || uint64_t(filter->mines) > mines->maxValue))
+        return false;
+    return true;
+}
+
+bool rowMatches(const GroupView& view, size_t row, const AnalyticsFilter& filter) {
+    return view[ColGridSize][row] == uint64_t(filter.gridSize) &&
+           (filter.mines < 0 || view[ColMines][row] == uint64_t(filter.mines));
+}
+
+// Параллельный проход по группам таблицы: каждая группа - задача пула,
+// распаковываются только нужные колонки, результат копится в аккумуляторе потока
+template <typename Acc, typename Fn>
+std::vector<Acc> scanTable(const std::vector<std::unique_ptr<Segment>>& segments, AnalyticsTable table,
+                           const std::vector<AnalyticsColumn>& needed, const AnalyticsFilter *filter,
+                           unsigned threads, const Acc& init, Fn fn) {
+    WorkStealingPool pool(threads);
+    std::vector<Acc> perWorker(pool.size(), init);
+
+    for (const auto& segment : segments) {
+        const Segment *s = segment.get();
+        for (uint32_t g = 0; g < s->header.groupCount; ++g) {
+            const GroupEntry& group = s->group(g);
+            if (group.table != uint8_t(table) || !groupMayMatch(*s, group, filter)) continue;
+
+            pool.submit([s, &group, &needed, &perWorker, &fn] {
+                std::vector<uint64_t> decoded[ColumnCount];
+                GroupView view;
+                view.rows = group.rowCount;
+
+                const ColumnEntry *columns = s->columns(group);
+                const uint8_t *data = reinterpret_cast<const uint8_t *>(columns + group.columnCount);
+                for (int c = 0; c < group.columnCount; ++c) {
+                    const ColumnEntry& entry = columns[c];
+                    if (std::find(needed.begin(), needed.end(), AnalyticsColumn(entry.column)) != needed.end()) {
+                        if (!decodeColumn(entry, data, group.rowCount, decoded[entry.column])) return;
+                        view.columns[entry.column] = &decoded[entry.column];
+                    }
+                    data += entry.byteSize;
+                }
+                for (AnalyticsColumn c : needed)
+                    if (!view.columns[c]) return;
+                fn(perWorker[WorkStealingPool::workerIndex()], view);
+            });
+        }
+    }
+    pool.wait();
+    return perWorker;
+}
+
+void appendBytes(std::vector<uint8_t>& out, const void *data, size_t size) {
+    auto bytes = static_cast<const uint8_t *>(data);
+    out.insert(out.end(), bytes, bytes + size);
+}
+
+std::map<std::string, size_t> readSources(const std::string& path) {
+    std::map<std::string, size_t> sources;
+    std::ifstream in(path);
+    size_t count;
+    std::string name;
+    while (in >> count && std::getline(in >> std::ws, name)) sources[name] = count;
+    return sources;
+}
+
+} // namespace
+
+AnalyticsStore::AnalyticsStore(const std::string& directory, unsigned threads)
+    : directory(directory), threads(threads) {
+    std::error_code error;
+    fs::create_directories(directory, error);
+}
+
+void AnalyticsStore::addGame(const RecordedGame& game) {
+    const int n = game.gridSize();
+    const uint64_t mines = game.mines() ? 1 : 0;
+    Columns& games = buffers[int(AnalyticsTable::Games)];
+    const uint64_t gameIndex = games.values[ColGridSize].size();
+
+    uint64_t sideShots[2] = {0, 0};
+    Columns& shots = buffers[int(AnalyticsTable::Shots)];
+    for (int k = 0; k < game.shotCount(); ++k) {
+        rules::ShotEvent s = game.shot(k);
+        ++sideShots[s.player & 1];
+        shots.values[ColGridSize].push_back(uint64_t(n));
+        shots.values[ColMines].push_back(mines);
+        shots.values[ColGame].push_back(gameIndex);
+        shots.values[ColMove].push_back(uint64_t(k));
+        shots.values[ColPlayer].push_back(s.player);
+        shots.values[ColCell].push_back(uint64_t(s.y * n + s.x));
+        shots.values[ColKind].push_back(uint64_t(s.kind));
+        shots.values[ColSunk].push_back(s.sunkCount);
+    }
+
+    games.values[ColGridSize].push_back(uint64_t(n));
+    games.values[ColMines].push_back(mines);
+    games.values[ColWinner].push_back(uint64_t(game.winner() + 1));
+    games.values[ColFirstPlayer].push_back(uint64_t(game.firstPlayer()));
+    games.values[ColShotCount].push_back(uint64_t(game.shotCount()));
+    games.values[ColShots0].push_back(sideShots[0]);
+    games.values[ColShots1].push_back(sideShots[1]);
+    games.values[ColStartTime].push_back(game.startTime());
+
+    // Поле сетевого соперника известно не полностью и в статистику расстановок не идёт
+    Columns& boards = buffers[int(AnalyticsTable::Boards)];
+    for (int side = 0; side < 2; ++side) {
+        if (game.partial(side)) continue;
+        const Grid board = game.initialBoard(side);
+        uint64_t mask[3] = {0, 0, 0};
+        for (int y = 0; y < n; ++y)
+            for (int x = 0; x < n; ++x)
+                if (board[x][y] == Ship) mask[(y * n + x) >> 6] |= uint64_t(1) << ((y * n + x) & 63);
+        boards.values[ColGridSize].push_back(uint64_t(n));
+        boards.values[ColMines].push_back(mines);
+        boards.values[ColSide].push_back(uint64_t(side));
+        boards.values[ColMask0].push_back(mask[0]);
+        boards.values[ColMask1].push_back(mask[1]);
+        boards.values[ColMask2].push_back(mask[2]);
+    }
+    ++pending;
+}
+
+bool AnalyticsStore::commit() {
+    if (pending == 0) return true;
+    if (!writeSegment(nextSegmentPath(), buffers)) return false;
+    for (auto& table : buffers)
+        for (auto& column : table.values) column.clear();
+    pending = 0;
+    return true;
+}
+
+bool AnalyticsStore::writeSegment(const std::string& path, const Columns tables[3]) const {
+    SegmentHeader header{};
+    std::memcpy(header.magic, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC));
+    header.version = ANALYTICS_VERSION;
+
+    struct Group {
+        GroupEntry entry;
+        std::vector<uint8_t> body;
+    };
+    std::vector<Group> groups;
+    for (int t = 0; t < 3; ++t) {
+        const auto& columns = tableColumns(t);
+        const size_t rows = tables[t].values[ColGridSize].size();
+        header.rowCount[t] = rows;
+        for (size_t first = 0; first < rows; first += ANALYTICS_GROUP_ROWS) {
+            const size_t count = std::min<size_t>(ANALYTICS_GROUP_ROWS, rows - first);
+            Group group{};
+            group.entry.table = uint8_t(t);
+            group.entry.columnCount = uint8_t(columns.size());
+            group.entry.rowCount = uint32_t(count);
+
+            std::vector<ColumnEntry> entries;
+            std::vector<uint8_t> data;
+            for (AnalyticsColumn c : columns)
+                entries.push_back(encodeColumn(c, tables[t].values[c].data() + first, count, data));
+            appendBytes(group.body, entries.data(), entries.size() * sizeof(ColumnEntry));
+            appendBytes(group.body, data.data(), data.size());
+            group.body.resize((group.body.size() + 7) / 8 * 8, 0);
+            groups.push_back(std::move(group));
+        }
+    }
+    header.groupCount = uint32_t(groups.size());
+
+    uint64_t offset = (sizeof(SegmentHeader) + groups.size() * sizeof(GroupEntry) + 7) / 8 * 8;
+    for (auto& g : groups) {
+        g.entry.offset = offset;
+        offset += g.body.size();
+    }
+
+    std::vector<uint8_t> out;
+    out.reserve(size_t(offset));
+    appendBytes(out, &header, sizeof(header));
+    for (const auto& g : groups) appendBytes(out, &g.entry, sizeof(GroupEntry));
+    out.resize((out.size() + 7) / 8 * 8, 0);
+    for (const auto& g : groups) appendBytes(out, g.body.data(), g.body.size());
+
+    // Пишем во временный файл и переименовываем: запрос не увидит сегмент наполовину
+    const std::string temp = path + ".tmp";
+    {
+        std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char *>(out.data()), std::streamsize(out.size()));
+        if (!file) return false;
+    }
+    std::error_code error;
+    fs::rename(temp, path, error);
+    return !error;
+}
+
+size_t AnalyticsStore::ingestArchive(const GameArchive& archive, const std::string& source) {
+    const std::string sourcesPath = (fs::path(directory) / SOURCES_FILE).string();
+    std::map<std::string, size_t> sources = readSources(sourcesPath);
+
+    auto saveProgress = [&](size_t done) {
+        if (!commit()) return false;
+        sources[source] = done;
+        {
+            std::ofstream out(sourcesPath + ".tmp", std::ios::trunc);
+            for (const auto& s : sources) out << s.second << ' ' << s.first << '\n';
+        }
+        std::error_code error;
+        fs::rename(sourcesPath + ".tmp", sourcesPath, error);
+        return !error;
+    };
+
+    // Архив только дописывается; если он стал короче, значит его заменили - берём заново.
+    // Большой архив режется на сегменты, чтобы буфер не рос без предела
+    size_t from = sources[source];
+    if (from > archive.gameCount()) from = 0;
+    for (size_t i = from; i < archive.gameCount(); ++i) {
+        addGame(archive.game(i));
+        if (buffers[int(AnalyticsTable::Shots)].values[ColGridSize].size() >= SEGMENT_SHOT_ROWS &&
+            !saveProgress(i + 1))
+            return i + 1 - from;
+    }
+    if (from == archive.gameCount() || !saveProgress(archive.gameCount())) return 0;
+    return archive.gameCount() - from;
+}
+
+bool AnalyticsStore::compact() {
+    // Сливаются только мелкие сегменты слежения за архивом; полные сегменты
+    // большой загрузки не трогаем, чтобы не распаковывать всё хранилище разом
+    std::vector<std::string> files;
+    std::vector<std::unique_ptr<Segment>> segments;
+    for (const auto& path : segmentFiles()) {
+        auto s = loadSegment(path);
+        if (!s || s->header.rowCount[int(AnalyticsTable::Shots)] >= SEGMENT_SHOT_ROWS) continue;
+        files.push_back(path);
+        segments.push_back(std::move(s));
+    }
+    if (segments.size() < 2) return true;
+
+    // Колонки всех сегментов подряд; номера партий сдвигаются на партии предыдущих сегментов
+    auto merged = std::make_unique<Columns[]>(3);
+    std::vector<uint64_t> decoded;
+    for (const auto& segment : segments) {
+        const uint64_t gameBase = merged[int(AnalyticsTable::Games)].values[ColGridSize].size();
+        for (uint32_t g = 0; g < segment->header.groupCount; ++g) {
+            const GroupEntry& group = segment->group(g);
+            const ColumnEntry *columns = segment->columns(group);
+            const uint8_t *data = reinterpret_cast<const uint8_t *>(columns + group.columnCount);
+            for (int c = 0; c < group.columnCount; ++c) {
+                if (!decodeColumn(columns[c], data, group.rowCount, decoded)) return false;
+                if (columns[c].column == ColGame)
+                    for (auto& v : decoded) v += gameBase;
+                auto& target = merged[group.table].values[columns[c].column];
+                target.insert(target.end(), decoded.begin(), decoded.end());
+                data += columns[c].byteSize;
+            }
+        }
+    }
+
+    const std::string path = nextSegmentPath();
+    if (!writeSegment(path, merged.get())) return false;
+    std::error_code error;
+    for (const auto& f : files) fs::remove(f, error);
+    return true;
+}
+
+std::string AnalyticsStore::nextSegmentPath() const {
+    int last = 0;
+    for (const auto& f : segmentFiles())
+        last = std::max(last, std::atoi(fs::path(f).stem().string().c_str() + 8));
+    char name[32];
+    std::snprintf(name, sizeof(name), "segment-%06d.col", last + 1);
+    return (fs::path(directory) / name).string();
+}
+
+std::vector<std::string> AnalyticsStore::segmentFiles() const {
+    std::vector<std::string> files;
+    std::error_code error;
+    for (fs::directory_iterator it(directory, error), end; !error && it != end; it.increment(error)) {
+        const std::string name = it->path().filename().string();
+        if (name.rfind("segment-", 0) == 0 && it->path().extension() == ".col")
+            files.push_back(it->path().string());
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+StoreInfo AnalyticsStore::info() const {
+    StoreInfo result;
+    for (const auto& s : loadSegments(segmentFiles())) {
+        ++result.segments;
+        result.bytes += s->size;
+        for (int t = 0; t < 3; ++t) {
+            result.rows[t] += s->header.rowCount[t];
+            result.rawBytes += s->header.rowCount[t] * tableColumns(t).size() * 8;
+        }
+    }
+    return result;
+}
+
+std::vector<double> AnalyticsStore::placementHeatMap(const AnalyticsFilter& filter) const {
+    const int cells = filter.gridSize * filter.gridSize;
+    struct Acc {
+        uint64_t boards = 0;
+        std::vector<uint64_t> counts;
+    };
+    Acc init;
+    init.counts.assign(size_t(cells), 0);
+
+    auto perWorker = scanTable(
+        loadSegments(segmentFiles()), AnalyticsTable::Boards, {ColGridSize, ColMines, ColMask0, ColMask1, ColMask2},
+        &filter, threads, init, [&filter, cells](Acc& acc, const GroupView& view) {
+            const std::vector<uint64_t> *masks[3] = {&view[ColMask0], &view[ColMask1], &view[ColMask2]};
+            for (size_t r = 0; r < view.rows; ++r) {
+                if (!rowMatches(view, r, filter)) continue;
+                ++acc.boards;
+                for (int w = 0; w < 3; ++w) {
+                    for (uint64_t bits = (*masks[w])[r]; bits; bits &= bits - 1) {
+                        int cell = w * 64 + __builtin_ctzll(bits);
+                        if (cell < cells) ++acc.counts[size_t(cell)];
+                    }
+                }
+            }
+        });
+
+    uint64_t boards = 0;
+    std::vector<double> heat(size_t(cells), 0.0);
+    for (const auto& acc : perWorker) {
+        boards += acc.boards;
+        for (int c = 0; c < cells; ++c) heat[size_t(c)] += double(acc.counts[size_t(c)]);
+    }
+    if (boards)
+        for (auto& h : heat) h /= double(boards);
+    return heat;
+}
+
+std::vector<uint64_t> AnalyticsStore::shotHeatMap(const AnalyticsFilter& filter, int maxMove) const {
+    const int cells = filter.gridSize * filter.gridSize;
+    auto perWorker = scanTable(
+        loadSegments(segmentFiles()), AnalyticsTable::Shots, {ColGridSize, ColMines, ColMove, ColCell},
+        &filter, threads, std::vector<uint64_t>(size_t(cells), 0),
+        [&filter, cells, maxMove](std::vector<uint64_t>& counts, const GroupView& view) {
+            const auto& move = view[ColMove];
+            const auto& cell = view[ColCell];
+            for (size_t r = 0; r < view.rows; ++r) {
+                if ((maxMove > 0 && move[r] >= uint64_t(maxMove)) || !rowMatches(view, r, filter)) continue;
+                if (cell[r] < uint64_t(cells)) ++counts[cell[r]];
+            }
+        });
+
+    std::vector<uint64_t> heat(size_t(cells), 0);
+    for (const auto& counts : perWorker)
+        for (int c = 0; c < cells; ++c) heat[size_t(c)] += counts[size_t(c)];
+    return heat;
+}
+
+std::vector<uint64_t> AnalyticsStore::shotCountHistogram(const AnalyticsFilter& filter) const {
+    auto perWorker = scanTable(
+        loadSegments(segmentFiles()), AnalyticsTable::Games, {ColGridSize, ColMines, ColWinner, ColShotCount},
+        &filter, threads, std::vector<uint64_t>(),
+        [&filter](std::vector<uint64_t>& histogram, const GroupView& view) {
+            const auto& winner = view[ColWinner];
+            const auto& shots = view[ColShotCount];
+            for (size_t r = 0; r < view.rows; ++r) {
+                if (winner[r] == 0 || !rowMatches(view, r, filter)) continue;
+                if (histogram.size() <= shots[r]) histogram.resize(size_t(shots[r]) + 1, 0);
+                ++histogram[shots[r]];
+            }
+        });
+
+    std::vector<uint64_t> histogram;
+    for (const auto& h : perWorker) {
+        if (histogram.size() < h.size()) histogram.resize(h.size(), 0);
+        for (size_t s = 0; s < h.size(); ++s) histogram[s] += h[s];
+    }
+    return histogram;
+}
+
+std::vector<AnalyticsSummary> AnalyticsStore::summary() const {
+    // Размер поля не больше 15 (как в архиве партий), режим мин - 0 или 1
+    auto perWorker = scanTable(
+        loadSegments(segmentFiles()), AnalyticsTable::Games,
+        {ColGridSize, ColMines, ColWinner, ColFirstPlayer, ColShotCount}, nullptr, threads,
+        std::vector<AnalyticsSummary>(32),
+        [](std::vector<AnalyticsSummary>& acc, const GroupView& view) {
+            for (size_t r = 0; r < view.rows; ++r) {
+                const uint64_t n = view[ColGridSize][r];
+                if (n > 15) continue;
+                AnalyticsSummary& s = acc[n * 2 + (view[ColMines][r] ? 1 : 0)];
+                ++s.games;
+                if (view[ColWinner][r] == 0) continue;
+                ++s.finished;
+                s.shots += view[ColShotCount][r];
+                if (view[ColWinner][r] - 1 == view[ColFirstPlayer][r]) ++s.firstPlayerWins;
+            }
+        });
+
+    std::vector<AnalyticsSummary> result;
+    for (size_t key = 0; key < 32; ++key) {
+        AnalyticsSummary total;
+        total.gridSize = int(key / 2);
+        total.mines = key & 1;
+        for (const auto& acc : perWorker) {
+            total.games += acc[key].games;
+            total.finished += acc[key].finished;
+            total.firstPlayerWins += acc[key].firstPlayerWins;
+            total.shots += acc[key].shots;
+        }
+        if (total.games) result.push_back(total);
+    }
+    return result;
+}
@@ -0,0 +1,150 @@
+// analyticsstore.h
+#ifndef ANALYTICSSTORE_H
+#define ANALYTICSSTORE_H
+
+#include "gamerecord.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Колоночное хранилище сыгранных партий для статистики. Каталог хранилища
+// содержит неизменяемые сегменты segment-NNNNNN.col; каждый commit пишет новый
+// сегмент, поэтому свежие партии видны запросам сразу после записи файла.
+// Сегмент (little-endian):
+//   SegmentHeader, затем groupCount записей GroupEntry;
+//   группа строк одной таблицы: columnCount записей ColumnEntry и сжатые колонки подряд.
+// Каждая колонка сжимается отдельно - берётся самый короткий из способов:
+// упаковка по битам от минимума, повторы (RLE) или разности в varint.
+// min/max колонки позволяют пропускать группы, не распаковывая их.
+const uint32_t ANALYTICS_VERSION = 1;
+const uint32_t ANALYTICS_GROUP_ROWS = 65536;
+
+enum class AnalyticsTable : uint8_t {
+    Games,      // строка на партию
+    Boards,     // строка на полностью известное начальное поле
+    Shots       // строка на выстрел
+};
+
+enum AnalyticsColumn : uint8_t {
+    // Общие для всех таблиц
+    ColGridSize,
+    ColMines,
+    // Games
+    ColWinner,          // 0 - не доиграна, 1 - сторона 0, 2 - сторона 1
+    ColFirstPlayer,
+    ColShotCount,
+    ColShots0,          // выстрелов стороны 0
+    ColShots1,
+    ColStartTime,
+    // Boards: корабли битами y * size + x
+    ColSide,
+    ColMask0,
+    ColMask1,
+    ColMask2,
+    // Shots
+    ColGame,            // номер партии внутри сегмента
+    ColMove,
+    ColPlayer,
+    ColCell,
+    ColKind,
+    ColSunk,
+    ColumnCount
+};
+
+enum class ColumnCodec : uint8_t { BitPack, Rle, DeltaVarint };
+
+struct SegmentHeader {
+    char magic[8];              // "SEACOL" + 2 нуля
+    uint32_t version;
+    uint32_t groupCount;
+    uint64_t rowCount[3];       // строк в каждой таблице
+};
+
+struct GroupEntry {
+    uint8_t table;
+    uint8_t columnCount;
+    uint16_t reserved;
+    uint32_t rowCount;
+    uint64_t offset;            // от начала файла до ColumnEntry группы
+};
+
+struct ColumnEntry {
+    uint8_t column;
+    uint8_t codec;
+    uint8_t bitWidth;
+    uint8_t reserved;
+    uint32_t byteSize;
+    uint64_t minValue;
+    uint64_t maxValue;
+};
+
+static_assert(sizeof(SegmentHeader) == 40, "segment header layout");
+static_assert(sizeof(GroupEntry) == 16, "group entry layout");
+static_assert(sizeof(ColumnEntry) == 24, "column entry layout");
+
+// Отбор партий: gridSize обязателен, mines: -1 - любые, 0 - без мин, 1 - с минами
+struct AnalyticsFilter {
+    int gridSize = 10;
+    int mines = -1;
+};
+
+struct AnalyticsSummary {
+    int gridSize = 0;
+    bool mines = false;
+    uint64_t games = 0;
+    uint64_t finished = 0;
+    uint64_t firstPlayerWins = 0;
+    uint64_t shots = 0;
+};
+
+struct StoreInfo {
+    size_t segments = 0;
+    uint64_t rows[3] = {0, 0, 0};
+    uint64_t bytes = 0;         // на диске
+    uint64_t rawBytes = 0;      // те же колонки по 8 байт на значение
+};
+
+class AnalyticsStore {
+public:
+    explicit AnalyticsStore(const std::string& directory, unsigned threads = 0);
+
+    // Партия попадает в буфер; на диск - при commit
+    void addGame(const RecordedGame& game);
+    size_t pendingGames() const { return pending; }
+    // Записывает буфер новым сегментом; false - ошибка записи
+    bool commit();
+    // Добавляет партии архива, которых ещё нет в хранилище, и сразу пишет сегмент.
+    // Сколько партий каждого архива уже взято, хранится в файле sources каталога.
+    // Возвращает число новых партий
+    size_t ingestArchive(const GameArchive& archive, const std::string& source);
+    // Сливает мелкие сегменты в один, чтобы частые commit не плодили файлы
+    bool compact();
+
+    std::vector<std::string> segmentFiles() const;
+    StoreInfo info() const;
+
+    // Доля полей с кораблём в каждой клетке, индекс y * size + x
+    std::vector<double> placementHeatMap(const AnalyticsFilter& filter) const;
+    // Число выстрелов в каждую клетку среди первых maxMove ходов партии (0 - все)
+    std::vector<uint64_t> shotHeatMap(const AnalyticsFilter& filter, int maxMove = 0) const;
+    // Распределение числа выстрелов за доигранную партию
+    std::vector<uint64_t> shotCountHistogram(const AnalyticsFilter& filter) const;
+    // Сводка по каждому размеру поля и режиму мин
+    std::vector<AnalyticsSummary> summary() const;
+
+private:
+    struct Columns {
+        std::vector<uint64_t> values[ColumnCount];
+    };
+
+    std::string directory;
+    unsigned threads;
+    size_t pending = 0;
+    Columns buffers[3];
+
+    std::string nextSegmentPath() const;
+    bool writeSegment(const std::string& path, const Columns tables[3]) const;
+};
+
+#endif // ANALYTICSSTORE_H
@@ -0,0 +1,177 @@
+#include "battleshipai.h"
+#include <algorithm>
+#include <map>
+
+namespace {
+
+uint64_t rowMask(int n) {
+    return n >= 64 ? ~uint64_t(0) : ((uint64_t(1) << n) - 1);
+}
+
+// Транспонирование битовой доски: строка x результата - столбец x исходной
+void transpose(const std::vector<uint64_t>& rows, int n, std::vector<uint64_t>& out) {
+    out.assign(n, 0);
+    for (int y = 0; y < n; ++y) {
+        uint64_t r = rows[y];
+        while (r) {
+            int x = __builtin_ctzll(r);
+            out[x] |= uint64_t(1) << y;
+            r &= r - 1;
+        }
+    }
+}
+
+// Покрытие клеток строки расстановками длины len, начинающимися в битах starts:
+// клетку x покрывают начала из окна (x - len, x]. Счётчики всех клеток строки
+// считаются сразу - сдвинутые копии starts складываются в битовые плоскости
+// (plane[i] - бит i счётчика каждой клетки), как в сумматоре с переносом.
+// Потом каждая плоскость добавляется в acc с весом weight << i.
+void accumulateRow(uint64_t starts, int n, int len, uint32_t weight, uint32_t *acc) {
+    const int planes = 32 - __builtin_clz(uint32_t(len));   // счётчик не больше len
+    uint64_t plane[7] = {};
+    for (int k = 0; k < len; ++k) {
+        uint64_t carry = starts << k;
+        for (int i = 0; i < planes; ++i) {
+            uint64_t sum = plane[i] ^ carry;
+            carry &= plane[i];
+            plane[i] = sum;
+        }
+    }
+
+    for (int i = 0; i < planes; ++i) {
+        const uint64_t bits = plane[i];
+        const uint32_t w = weight << i;
+        for (int x = 0; x < n; ++x)
+            acc[x] += uint32_t((bits >> x) & 1) * w;
+    }
+}
+
+// Проход по всем строкам доски (или столбцам, если доска транспонирована)
+void accumulateBoard(const std::vector<uint64_t>& freeRows, const std::vector<uint64_t>& hitRows,
+                     int n, const std::map<int, int>& ships,
+                     std::vector<uint32_t>& hunt, std::vector<uint32_t>& target) {
+    for (int y = 0; y < n; ++y) {
+        uint64_t free = freeRows[y];
+        uint64_t hit = hitRows[y];
+        for (const auto& [len, count] : ships) {
+            if (len > n) continue;
+
+            // Начала, где все len клеток подряд свободны
+            uint64_t starts = free;
+            uint64_t touchesHit = hit;
+            for (int k = 1; k < len; ++k) {
+                starts &= free >> k;
+                touchesHit |= hit >> k;
+            }
+            if (!starts) continue;
+
+            accumulateRow(starts, n, len, uint32_t(count), &hunt[y * n]);
+            uint64_t hitStarts = starts & touchesHit;
+            if (hitStarts)
+                accumulateRow(hitStarts, n, len, uint32_t(count), &target[y * n]);
+        }
+    }
+}
+
+} // namespace
+
+void computeHeatMap(const BoardKnowledge& knowledge, HeatMap& out) {
+    const int n = knowledge.size;
+    out.size = n;
+    out.hunt.assign(n * n, 0);
+    out.target.assign(n * n, 0);
+    if (n <= 0 || n > MAX_AI_BOARD_SIZE) return;
+
+    // Корабли одного размера считаются за один проход с весом, равным их числу
+    std::map<int, int> ships;
+    for (int len : knowledge.remainingShips)
+        if (len > 0) ships[len]++;
+
+    const uint64_t full = rowMask(n);
+    std::vector<uint64_t> freeRows(n);
+    for (int y = 0; y < n; ++y)
+        freeRows[y] = ~(knowledge.miss[y] | knowledge.sunk[y]) & full;
+
+    // Горизонтальные расстановки
+    accumulateBoard(freeRows, knowledge.hit, n, ships, out.hunt, out.target);
+
+    // Вертикальные - те же строки на транспонированной доске
+    std::vector<uint64_t> freeCols, hitCols;
+    transpose(freeRows, n, freeCols);
+    transpose(knowledge.hit, n, hitCols);
+    std::vector<uint32_t> huntT(n * n, 0), targetT(n * n, 0);
+    accumulateBoard(freeCols, hitCols, n, ships, huntT, targetT);
+
+    for (int x = 0; x < n; ++x) {
+        for (int y = 0; y < n; ++y) {
+            out.hunt[y * n + x] += huntT[x * n + y];
+            out.target[y * n + x] += targetT[x * n + y];
+        }
+    }
+}
+
+BattleShipAI::BattleShipAI(unsigned seed) : rng(seed), mode(Hunt) {}
+
+std::pair<int, int> BattleShipAI::chooseShot(const BoardKnowledge& knowledge) {
+    // Пока все выстрелы - промахи, первые ходы берутся из книги
+    std::pair<int, int> bookShot;
+    if (openingBook && openingBook->nextShot(bookSection, knowledge, bookShot)) {
+        mode = Hunt;
+        return bookShot;
+    }
+
+    // Когда согласованных расстановок мало, ход считается точно
+    std::pair<int, int> exact;
+    if (endgame.currentConfig().layoutThreshold > 0 && endgame.solve(knowledge, exact)) {
+        mode = Endgame;
+        return exact;
+    }
+
+    computeHeatMap(knowledge, heat);
+    const int n = knowledge.size;
+
+    // Выбор максимума среди нестрелянных клеток; равные - случайно (reservoir sampling)
+    auto pick = [&](const std::vector<uint32_t>& scores) {
+        std::pair<int, int> best(-1, -1);
+        uint32_t bestScore = 0;
+        unsigned ties = 0;
+        for (int y = 0; y < n; ++y) {
+            for (int x = 0; x < n; ++x) {
+                if (!knowledge.canShoot(x, y)) continue;
+                uint32_t s = scores[y * n + x];
+                if (best.first < 0 || s > bestScore) {
+                    best = {x, y};
+                    bestScore = s;
+                    ties = 1;
+                } else if (s == bestScore && std::uniform_int_distribution<unsigned>(0, ties++)(rng) == 0) {
+                    best = {x, y};
+                }
+            }
+        }
+        return std::make_pair(best, bestScore);
+    };
+
+    if (knowledge.hasOpenHits()) {
+        auto [cell, score] = pick(heat.target);
+        if (score > 0) {
+            mode = Target;
+            return cell;
+        }
+    }
+
+    // Охота: если знание противоречиво и карта пуста, выбор всё равно случайный
+    mode = Hunt;
+    const uint16_t *prior = openingBook ? openingBook->occupancy(bookSection) : nullptr;
+    if (prior && bookSection->gridSize == n) {
+        // Частота кораблей в клетке по книге против среднего: поля людей неравномерны
+        uint64_t total = 0;
+        for (int i = 0; i < n * n; ++i) total += prior[i];
+        weighted.resize(heat.hunt.size());
+        for (int i = 0; i < n * n; ++i) {
+            double ratio = total ? double(prior[i]) * n * n / total : 1.0;
+            weighted[i] = uint32_t(heat.hunt[i] * (0.5 + 0.5 * ratio));
+        }
+        return pick(weighted).first;
+    }
+    return pick(heat.hunt).first;
+}
@@ -0,0 +1,57 @@
+// battleshipai.h
+#ifndef BATTLESHIPAI_H
+#define BATTLESHIPAI_H
+
+#include "boardknowledge.h"
+#include "endgamesolver.h"
+#include "openingbook.h"
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+// Тепловая карта: для каждой клетки число допустимых расстановок оставшихся
+// кораблей, которые её накрывают. Индекс клетки - y * size + x.
+struct HeatMap {
+    int size = 0;
+    std::vector<uint32_t> hunt;   // все допустимые расстановки
+    std::vector<uint32_t> target; // только расстановки, накрывающие открытые попадания
+};
+
+void computeHeatMap(const BoardKnowledge& knowledge, HeatMap& out);
+
+class BattleShipAI {
+public:
+    enum Mode { Hunt, Target, Endgame };
+
+    explicit BattleShipAI(unsigned seed = std::random_device{}());
+
+    // Возвращает клетку (x, y) для следующего выстрела или (-1, -1), если стрелять некуда
+    std::pair<int, int> chooseShot(const BoardKnowledge& knowledge);
+    Mode lastMode() const { return mode; }
+    const HeatMap& lastHeatMap() const { return heat; }
+    // Новая партия симулятора: повторяемый выбор при равных оценках
+    void reseed(unsigned seed) { rng.seed(seed); }
+
+    // Порог и потолок памяти точного решателя; layoutThreshold = 0 отключает его
+    void setEndgameConfig(const EndgameConfig& config) { endgame.setConfig(config); }
+    const EndgameConfig& endgameConfig() const { return endgame.currentConfig(); }
+    void setStopFlag(const std::atomic<bool> *flag) { endgame.setStopFlag(flag); }
+    // Дебютная книга для этого размера поля и режима мин; nullptr - без книги.
+    // Книга только читается и может быть общей для нескольких ИИ в разных потоках
+    void setOpeningBook(const OpeningBook *book, const BookSection *section) {
+        openingBook = book;
+        bookSection = section;
+    }
+
+private:
+    std::mt19937 rng;
+    HeatMap heat;
+    Mode mode;
+    EndgameSolver endgame;
+    const OpeningBook *openingBook = nullptr;
+    const BookSection *bookSection = nullptr;
+    std::vector<uint32_t> weighted;
+};
+
+#endif // BATTLESHIPAI_H
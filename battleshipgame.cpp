@@ -1,4 +1,11 @@
 #include "battleshipgame.h"
+#include "gamerules.h"
+#include "replayviewer.h"
+#include "ffaserver.h"
+#include "ffaview.h"
+#include <QDateTime>
+#include <QDir>
+#include <QStandardPaths>
 #include <QGraphicsRectItem>
 #include <QGraphicsTextItem>
 #include <QMouseEvent>
@@ -9,16 +16,63 @@
 #include <QColor>
 #include <QInputDialog>
 #include <QHostAddress>
+#include <algorithm>
 #include <ctime>
 #include <cstdlib>
 #include <utility>
 #include <random>
 
+namespace {
+// Архив записанных партий пользователя
+QString gameArchivePath() {
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(dir);
+    return dir + "/games.sea";
+}
+
+// Клетки залпа в сообщении SALVO: "x,y;x,y;..."
+QString encodeSalvo(const std::vector<std::pair<int, int>>& cells) {
+    QStringList parts;
+    for (auto [x, y] : cells) parts << QString::number(x) + "," + QString::number(y);
+    return parts.join(';');
+}
+
+std::vector<std::pair<int, int>> decodeSalvo(const QString& data) {
+    std::vector<std::pair<int, int>> cells;
+    for (const QString& part : data.split(';', Qt::SkipEmptyParts)) {
+        QStringList coords = part.split(',');
+        if (coords.size() == 2) cells.emplace_back(coords[0].toInt(), coords[1].toInt());
+    }
+    return cells;
+}
+
+// Ответ SALVO_RESULT: по записи "x,y,исход,маска,длины" на каждый выстрел залпа.
+// Исход: M - промах, H - попадание, X - мина, R - повтор; маска - подбитые взрывом
+// соседние клетки; длины потопленных этим выстрелом кораблей через '/'.
+// Ответ MINE_HIT на одиночный выстрел - одна такая запись
+QString encodeSalvoResult(const std::vector<std::pair<int, int>>& shots,
+                          const std::vector<rules::ShotResult>& results) {
+    QStringList entries;
+    for (size_t i = 0; i < shots.size(); ++i) {
+        const rules::ShotResult& r = results[i];
+        auto [x, y] = shots[i];
+        const char kind = r.kind == rules::ShotResult::Miss ? 'M' : r.kind == rules::ShotResult::Hit ? 'H'
+                        : r.kind == rules::ShotResult::MineHit ? 'X' : 'R';
+        const int mask = rules::mineBlastMask(x, y, r);
+        QStringList sizes;
+        for (const auto& cells : r.sunkShips) sizes << QString::number(cells.size());
+        entries << QString("%1,%2,%3,%4,%5").arg(x).arg(y).arg(QChar::fromLatin1(kind)).arg(mask).arg(sizes.join('/'));
+    }
+    return entries.join(';');
+}
+}
+
 BattleShipGame::BattleShipGame(QWidget *parent) : QGraphicsView(parent),
     placing(true), horizontal(true), currentShipIndex(0), myTurn(false),
     gameEnded(false), server(nullptr), socket(nullptr), isServer(false),
     gridSize(Size10x10), cellSize(DEFAULT_CELL_SIZE), minesEnabled(false),
-    minesCount(2)
+    minesCount(2), vsComputer(false), moveProvider(nullptr), useMonteCarlo(false),
+    autoPlay(false), awaitingReply(false), rng(std::random_device{}())
 {
     scene = new QGraphicsScene(this);
     setScene(scene);
@@ -38,6 +92,8 @@ BattleShipGame::BattleShipGame(QWidget *parent) : QGraphicsView(parent),
     setFocus();
     setMouseTracking(true);
 
+    loadOpeningBook();
+    recordWriter = std::make_unique<RecordWriter>(gameArchivePath().toStdString());
     showGameOptions();
     hitSound.setSource(QUrl::fromLocalFile(":/sounds/hit.wav"));
     hitSound.setVolume(0.8f);
@@ -73,16 +129,36 @@ void BattleShipGame::showGameOptions() {
     // Режим мин
     QCheckBox *minesCheck = new QCheckBox("Режим 'Мины' (2 мины на поле)", &optionsDialog);
 
+    // Соперник - компьютер вместо второго игрока по сети
+    QCheckBox *computerCheck = new QCheckBox("Игра против компьютера", &optionsDialog);
+    // В сетевой игре корабли расставляет и стреляет ИИ
+    QCheckBox *autoPlayCheck = new QCheckBox("Компьютер играет за меня (по сети)", &optionsDialog);
+    QCheckBox *monteCarloCheck = new QCheckBox("ИИ Монте-Карло вместо тепловой карты", &optionsDialog);
+    // Программа на любом языке, говорящая по протоколу ботов через stdin/stdout
+    QCheckBox *botCheck = new QCheckBox("Внешний бот вместо встроенного ИИ...", &optionsDialog);
+    // Оба игрока по сети должны выбрать одинаково, как размер поля и мины
+    QCheckBox *salvoCheck = new QCheckBox("Режим залпов (выстрелов за ход - по числу своих кораблей)", &optionsDialog);
+    // Отдельная партия на одном сервере: каждый стреляет по полю любого из соперников
+    QCheckBox *ffaCheck = new QCheckBox("Все против всех по сети (4-16 игроков)", &optionsDialog);
+
     // Кнопки
     QPushButton *okButton = new QPushButton("Начать игру", &optionsDialog);
     QPushButton *cancelButton = new QPushButton("Выход", &optionsDialog);
+    QPushButton *replayButton = new QPushButton("Записи партий", &optionsDialog);
 
     QHBoxLayout *buttonLayout = new QHBoxLayout;
     buttonLayout->addWidget(okButton);
+    buttonLayout->addWidget(replayButton);
     buttonLayout->addWidget(cancelButton);
 
     layout->addWidget(sizeGroup);
     layout->addWidget(minesCheck);
+    layout->addWidget(computerCheck);
+    layout->addWidget(autoPlayCheck);
+    layout->addWidget(monteCarloCheck);
+    layout->addWidget(botCheck);
+    layout->addWidget(salvoCheck);
+    layout->addWidget(ffaCheck);
     layout->addLayout(buttonLayout);
 
     connect(okButton, &QPushButton::clicked, [&]() {
@@ -92,16 +168,34 @@ void BattleShipGame::showGameOptions() {
 
         cellSize = (gridSize == Size12x12) ? 35 : DEFAULT_CELL_SIZE;
         minesEnabled = minesCheck->isChecked();
+        vsComputer = computerCheck->isChecked();
+        autoPlay = autoPlayCheck->isChecked() && !vsComputer;
+        useMonteCarlo = monteCarloCheck->isChecked();
+        salvoMode = salvoCheck->isChecked();
+        botCommand.clear();
+        if (botCheck->isChecked() && (vsComputer || autoPlay)) {
+            bool ok;
+            QString command = QInputDialog::getText(&optionsDialog, "Внешний бот", "Команда запуска бота:",
+                                                    QLineEdit::Normal, "sea_bot", &ok).trimmed();
+            if (!ok || command.isEmpty()) return;
+            botCommand = command;
+        }
 
         optionsDialog.accept();
         qDebug() << "Options selected - gridSize:" << gridSize
                  << "cellSize:" << cellSize
                  << "minesEnabled:" << minesEnabled;
 
-        initializeGame();
+        if (ffaCheck->isChecked()) startFreeForAll();
+        else initializeGame();
     });
 
     connect(cancelButton, &QPushButton::clicked, &optionsDialog, &QDialog::reject);
+    connect(replayButton, &QPushButton::clicked, [&]() {
+        recordWriter->flush();
+        ReplayViewer viewer(gameArchivePath(), &optionsDialog);
+        viewer.exec();
+    });
 
     if (optionsDialog.exec() == QDialog::Rejected) {
         QCoreApplication::quit();
@@ -126,14 +220,41 @@ void BattleShipGame::initializeGame() {
 
     initializeFleet();
 
+    // Мины противника стоят на его поле: о взрыве он сообщит в ответ на выстрел
     if (minesEnabled) {
         placeMines(playerGrid);
-        placeMines(opponentGrid);
     }
 
     messageTimer = new QTimer(this);
     connect(messageTimer, &QTimer::timeout, this, &BattleShipGame::hideMessage);
 
+    opponentSunk.assign(gridSize, std::vector<bool>(gridSize, false));
+    salvoTargets.clear();
+    computerSalvo.clear();
+    if ((vsComputer || autoPlay) && !botCommand.isEmpty()) {
+        // Бот получает размер поля и флот из initializeFleet, мины - только их число
+        BotMoveProvider *bot = new BotMoveProvider(botCommand, AI_TIME_BUDGET_MS, this);
+        bot->newGame(gridSize, minesEnabled ? minesCount : 0, remainingShipSizes(playerFleet));
+        moveProvider = bot;
+        connect(moveProvider, &MoveProvider::moveReady, this, &BattleShipGame::onEngineMove);
+        connect(bot, &BotMoveProvider::placementReady, this, &BattleShipGame::onBotPlacement);
+    } else if (vsComputer || autoPlay) {
+        EngineMoveProvider *engine = new EngineMoveProvider(
+            useMonteCarlo ? EngineMoveProvider::MonteCarloEngine : EngineMoveProvider::HeatMapEngine,
+            AI_TIME_BUDGET_MS, this);
+        if (openingBook.isLoaded()) {
+            engine->setOpeningBook(&openingBook, openingBook.find(gridSize, minesEnabled));
+        }
+        moveProvider = engine;
+        connect(moveProvider, &MoveProvider::moveReady, this, &BattleShipGame::onEngineMove);
+    }
+
+    if (vsComputer) {
+        setupComputerOpponent();
+        drawGrids();
+        return;
+    }
+
     // Запрос у пользователя, хочет ли он создать игру или подключиться
     QMessageBox::StandardButton reply = QMessageBox::question(
         this, "Сетевая игра",
@@ -157,54 +278,128 @@ void BattleShipGame::initializeFleet() {
     playerFleet.clear();
     opponentFleet.clear();
 
-    switch (gridSize) {
-    case Size8x8:
-        playerFleet = {
-            {3, 1, 1, "Линкор"},
-            {2, 2, 2, "Крейсер"},
-            {1, 3, 3, "Катер"}
-        };
-        break;
-    case Size10x10:
-        playerFleet = {
-            {4, 1, 1, "Линкор"},
-            {3, 2, 2, "Крейсер"},
-            {2, 3, 3, "Эсминец"},
-            {1, 4, 4, "Катер"}
-        };
-        break;
-    case Size12x12:
-        playerFleet = {
-            {5, 1, 1, "Авианосец"},
-            {4, 1, 1, "Линкор"},
-            {3, 2, 2, "Крейсер"},
-            {2, 3, 3, "Эсминец"},
-            {1, 4, 4, "Катер"}
-        };
-        break;
+    for (const auto& s : rules::fleetFor(gridSize)) {
+        playerFleet.push_back({s.size, s.count, s.count, QString::fromUtf8(s.name)});
     }
 
     opponentFleet = playerFleet;
 }
 
-void BattleShipGame::placeMines(Grid& grid) {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(0, gridSize - 1);
+std::vector<int> BattleShipGame::remainingShipSizes(const std::vector<ShipInfo>& fleet) const {
+    std::vector<int> sizes;
+    for (const auto& s : fleet) {
+        for (int i = 0; i < s.remaining; ++i) sizes.push_back(s.size);
+    }
+    return sizes;
+}
+
+void BattleShipGame::loadOpeningBook() {
+    // Файл собирается утилитой sea_book и лежит рядом с программой; без него ИИ играет без книги
+    bookFile.setFileName(QCoreApplication::applicationDirPath() + "/opening.book");
+    if (!bookFile.exists() || !bookFile.open(QIODevice::ReadOnly)) return;
+
+    // Отображение вместо чтения: время загрузки не зависит от размера книги
+    uchar *data = bookFile.map(0, bookFile.size());
+    if (!data || !openingBook.attach(data, size_t(bookFile.size()))) {
+        qWarning() << "Opening book is damaged or has another version:" << bookFile.fileName();
+        bookFile.close();
+        return;
+    }
+    qDebug() << "Opening book loaded:" << bookFile.fileName() << bookFile.size() << "bytes";
+}
+
+void BattleShipGame::setupComputerOpponent() {
+    // Компьютер расставляет корабли на скрытом поле, мины тоже ставятся туда
+    computerGrid.assign(gridSize, std::vector<Cell>(gridSize, Empty));
+    setupOpponentGrid();
+    if (minesEnabled) {
+        placeMines(computerGrid);
+    }
+    // Бот расставляет флот, пока игрок расставляет свой; ответ придёт в onBotPlacement
+    BotMoveProvider *bot = qobject_cast<BotMoveProvider *>(moveProvider);
+    if (bot) bot->requestPlacement(computerGrid, remainingShipSizes(opponentFleet));
+    else placeFleetRandomly(computerGrid, opponentFleet);
+    showMessage("Расставьте корабли. Противник - компьютер.", false);
+}
+
+void BattleShipGame::placeFleetRandomly(Grid& grid, const std::vector<ShipInfo>& fleet) {
+    std::vector<int> sizes;
+    for (const auto& s : fleet) {
+        for (int n = 0; n < s.count; ++n) sizes.push_back(s.size);
+    }
+    rules::placeFleetRandomly(grid, sizes, rng);
+}
 
-    int placed = 0;
-    while (placed < minesCount) {
-        int x = dis(gen);
-        int y = dis(gen);
+void BattleShipGame::playerShotAtComputer(int x, int y) {
+    lastShotX = x;
+    lastShotY = y;
 
-        if (grid[x][y] == Empty) {
-            grid[x][y] = Mine;
-            placed++;
+    rules::ShotResult result = rules::resolveShot(computerGrid, x, y);
+    recordShot(0, x, y, result.kind, int(result.sunkShips.size()));
+    // Как и в сетевой игре, после промаха и мины ход переходит к противнику
+    bool keepTurn = result.kind == rules::ShotResult::Hit || result.kind == rules::ShotResult::Repeat;
+
+    // Переносим открытые клетки на видимое поле противника
+    for (int cx = 0; cx < gridSize; ++cx) {
+        for (int cy = 0; cy < gridSize; ++cy) {
+            if (computerGrid[cx][cy] == Hit || computerGrid[cx][cy] == Miss)
+                opponentGrid[cx][cy] = computerGrid[cx][cy];
         }
     }
+
+    if (result.kind == rules::ShotResult::Miss) {
+        missSound.play();
+        showMessage("Вы промахнулись! Ходит компьютер...", false);
+    } else if (result.kind == rules::ShotResult::MineHit) {
+        showMessage("Мина! Взрыв задел соседние клетки.", true);
+    } else if (result.kind == rules::ShotResult::Hit) {
+        showMessage("Вы попали!", true);
+    }
+    if (!result.shipCellsHit.empty()) hitSound.play();
+
+    for (const auto& cells : result.sunkShips) {
+        for (auto& s : opponentFleet) {
+            if (s.remaining > 0 && s.size == (int)cells.size()) {
+                s.remaining--;
+                showMessage("Вы потопили " + s.name + " противника!");
+                break;
+            }
+        }
+    }
+
+    if (isGameOver(opponentFleet)) {
+        endGame(true);
+        return;
+    }
+
+    myTurn = keepTurn;
+    drawGrids();
+    if (!myTurn) {
+        QTimer::singleShot(600, this, &BattleShipGame::computerTurn);
+    }
+}
+
+void BattleShipGame::computerTurn() {
+    if (gameEnded || myTurn || !vsComputer) return;
+
+    // ИИ видит только промахи и попадания; скрытые корабли игрока ему неизвестны.
+    // Ход считается в потоке ИИ и придёт в onEngineMove
+    BoardKnowledge knowledge = BoardKnowledge::fromGrid(
+        playerGrid, remainingShipSizes(playerFleet),
+        [this](int x, int y) { return isShipSunk(playerGrid, x, y); });
+    // Уже выбранные клетки залпа ИИ не выбирает ещё раз, но корабли через них не исключает
+    for (auto [x, y] : computerSalvo) knowledge.excluded[y] |= uint64_t(1) << x;
+    moveProvider->requestMove(knowledge);
+}
+
+void BattleShipGame::placeMines(Grid& grid) {
+    rules::placeMines(grid, minesCount, rng);
 }
 
 BattleShipGame::~BattleShipGame() {
+    // Поток ИИ читает книгу, поэтому останавливаем его раньше, чем закроется файл
+    delete moveProvider;
+    moveProvider = nullptr;
     if (server) server->close();
     if (socket) socket->close();
     delete server;
@@ -213,6 +408,7 @@ BattleShipGame::~BattleShipGame() {
 
 void BattleShipGame::startNetworkGame(bool asServer) {
     isServer = asServer;
+    peerReady = false;
 
     if (asServer) {
         server = new QTcpServer(this);
@@ -239,6 +435,7 @@ void BattleShipGame::startNetworkGame(bool asServer) {
         socket = new QTcpSocket(this);
         connect(socket, &QTcpSocket::connected, this, [this]() {
             showMessage("Подключено к серверу. Ожидаем расстановки кораблей...", false);
+            if (autoPlay) autoPlaceFleet();
         });
         connect(socket, &QTcpSocket::readyRead, this, &BattleShipGame::readData);
         connect(socket, &QTcpSocket::disconnected, this, &BattleShipGame::disconnected);
@@ -249,6 +446,54 @@ void BattleShipGame::startNetworkGame(bool asServer) {
     }
 }
 
+void BattleShipGame::startFreeForAll() {
+    QMessageBox::StandardButton reply = QMessageBox::question(
+        this, "Все против всех",
+        "Хотите создать партию (сервер) или подключиться к существующей (клиент)?",
+        QMessageBox::Yes | QMessageBox::No | QMessageBox::Cancel
+        );
+    if (reply == QMessageBox::Cancel) {
+        QCoreApplication::quit();
+        return;
+    }
+
+    bool ok = true;
+    QString host = "127.0.0.1";
+    if (reply == QMessageBox::Yes) {
+        int players = QInputDialog::getInt(this, "Все против всех", "Число игроков:",
+                                           FFA_MIN_PLAYERS, FFA_MIN_PLAYERS, FFA_MAX_PLAYERS, 1, &ok);
+        if (!ok) {
+            QCoreApplication::quit();
+            return;
+        }
+        // Сервер живёт, пока жив этот объект: окно скрывается, но не закрывается
+        FfaServer *ffaServer = new FfaServer(gridSize, minesEnabled, minesCount, players, this);
+        if (!ffaServer->listen()) {
+            QMessageBox::critical(this, "Ошибка", "Не удалось запустить сервер: " + ffaServer->errorString());
+            QCoreApplication::quit();
+            return;
+        }
+    } else {
+        host = QInputDialog::getText(this, "Подключение к серверу", "Введите IP-адрес сервера:",
+                                     QLineEdit::Normal, host, &ok);
+        if (!ok) {
+            QCoreApplication::quit();
+            return;
+        }
+    }
+
+    QString name = QInputDialog::getText(this, "Все против всех", "Ваше имя:", QLineEdit::Normal, "Игрок", &ok);
+    if (!ok) {
+        QCoreApplication::quit();
+        return;
+    }
+
+    FfaView *view = new FfaView(host, FFA_PORT, name);
+    view->setAttribute(Qt::WA_DeleteOnClose);
+    view->show();
+    QTimer::singleShot(0, this, &QWidget::hide);
+}
+
 void BattleShipGame::sendMessage(const QString &message) {
     if (socket && socket->state() == QAbstractSocket::ConnectedState) {
         QByteArray data = (message + "\n").toUtf8(); // Добавляем символ новой строки
@@ -273,15 +518,17 @@ void BattleShipGame::processCommand(const QString &command, const QString &data)
             int x = coords[0].toInt();
             int y = coords[1].toInt();
 
-            if (playerGrid[x][y] == Ship) {
-                playerGrid[x][y] = Hit;
+            rules::ShotResult result = rules::resolveShot(playerGrid, x, y);
+            recordShot(1, x, y, result.kind, int(result.sunkShips.size()));
+            if (vsComputer && moveProvider) moveProvider->shotResult(x, y, result);
+
+            if (result.kind == rules::ShotResult::Hit) {
                 hitSound.play();
 
                 // Проверяем, не потоплен ли корабль
-                if (isShipSunk(playerGrid, x, y)) {
-                    auto cells = getShipCells(playerGrid, x, y);
+                if (!result.sunkShips.empty()) {
                     for (auto& s : playerFleet) {
-                        if (s.remaining > 0 && s.size == (int)cells.size()) {
+                        if (s.remaining > 0 && s.size == (int)result.sunkShips[0].size()) {
                             s.remaining--;
                             sendMessage("SUNK:" + QString::number(s.size));
                             showMessage("Противник потопил ваш " + s.name + "!", true);
@@ -297,42 +544,28 @@ void BattleShipGame::processCommand(const QString &command, const QString &data)
                     return;
                 }
             }
-            else if (playerGrid[x][y] == Mine) {
-                // Обработка попадания в мину
+            else if (result.kind == rules::ShotResult::MineHit) {
+                // Взрыв мины поразил соседние клетки: стрелявший узнаёт о них из одного
+                // ответа - где были корабли и какие потоплены
                 hitSound.play();
-                playerGrid[x][y] = Hit;
-
-                // Взрыв мины - поражаем соседние клетки
-                for (int dx = -1; dx <= 1; ++dx) {
-                    for (int dy = -1; dy <= 1; ++dy) {
-                        if (dx == 0 && dy == 0) continue;
-                        int nx = x + dx;
-                        int ny = y + dy;
-                        if (isInside(nx, ny)) {
-                            if (playerGrid[nx][ny] == Ship) {
-                                playerGrid[nx][ny] = Hit;
-                                if (isShipSunk(playerGrid, nx, ny)) {
-                                    auto cells = getShipCells(playerGrid, nx, ny);
-                                    for (auto& s : playerFleet) {
-                                        if (s.remaining > 0 && s.size == (int)cells.size()) {
-                                            s.remaining--;
-                                            sendMessage("SUNK:" + QString::number(s.size));
-                                            showMessage("Противник потопил ваш " + s.name + " (миной)!", true);
-                                            break;
-                                        }
-                                    }
-                                }
-                            }
-                            playerGrid[nx][ny] = Hit;
+                for (const auto& cells : result.sunkShips) {
+                    for (auto& s : playerFleet) {
+                        if (s.remaining > 0 && s.size == (int)cells.size()) {
+                            s.remaining--;
+                            showMessage("Противник потопил ваш " + s.name + " (миной)!", true);
+                            break;
                         }
                     }
                 }
 
-                sendMessage("MINE_HIT:" + data);
+                sendMessage("MINE_HIT:" + encodeSalvoResult({{x, y}}, {result}));
+                if (isGameOver(playerFleet)) {
+                    endGame(false);
+                    return;
+                }
                 myTurn = true; // После мины ход остается у атаковавшего
             }
-            else if (playerGrid[x][y] == Empty) {
-                playerGrid[x][y] = Miss;
+            else if (result.kind == rules::ShotResult::Miss) {
                 missSound.play();
                 sendMessage("MISS:" + data);
                 myTurn = true; // Передаем ход обратно
@@ -348,37 +581,109 @@ void BattleShipGame::processCommand(const QString &command, const QString &data)
             int x = coords[0].toInt();
             int y = coords[1].toInt();
             opponentGrid[x][y] = Hit;
+            awaitingReply = false;
+            recordShot(0, x, y, rules::ShotResult::Hit, 0);
             hitSound.play();
             showMessage("Вы попали!", true);
 
-            // Проверяем, не потоплен ли корабль
-            if (isShipSunk(opponentGrid, x, y)) {
-                auto cells = getShipCells(opponentGrid, x, y);
+            // О потоплении противник сообщает сам (SUNK), кораблей противника мы не видим
+
+            // Ход остаётся у текущего игрока при попадании
+            myTurn = true;
+        }
+    }
+    else if (command == "SUNK") {
+        // Ответ на наш последний выстрел: он добил корабль длины size
+        int size = data.toInt();
+        awaitingReply = false;
+        recordShot(0, lastShotX, lastShotY, rules::ShotResult::Hit, 1);
+        if (isInside(lastShotX, lastShotY)) {
+            opponentGrid[lastShotX][lastShotY] = Hit;
+            auto cells = getShipCells(opponentGrid, lastShotX, lastShotY);
+            if ((int)cells.size() == size) {
+                for (auto& [cx, cy] : cells) opponentSunk[cx][cy] = true;
+            }
+        }
+        for (auto& s : opponentFleet) {
+            if (s.remaining > 0 && s.size == size) {
+                s.remaining--;
+                hitSound.play();
+                showMessage("Вы потопили " + s.name + " противника!");
+                break;
+            }
+        }
+        myTurn = true;
+        if (isGameOver(opponentFleet)) {
+            endGame(true);
+            return;
+        }
+    }
+    else if (command == "MINE_HIT") {
+        // Выстрел попал в мину противника: "x,y,X,маска,длины", как запись SALVO_RESULT
+        QStringList f = data.split(',');
+        if (f.size() >= 5 && isInside(f[0].toInt(), f[1].toInt())) {
+            int x = f[0].toInt();
+            int y = f[1].toInt();
+            awaitingReply = false;
+            const int hits = revealMineBlast(x, y, f[3].toInt());
+            const QStringList sizes = f[4].split('/', Qt::SkipEmptyParts);
+            for (const QString& sizeText : sizes) {
+                int size = sizeText.toInt();
+                markOpponentSunk(x, y, size);
                 for (auto& s : opponentFleet) {
-                    if (s.remaining > 0 && s.size == (int)cells.size()) {
+                    if (s.remaining > 0 && s.size == size) {
                         s.remaining--;
-                        sendMessage("SUNK:" + QString::number(s.size));
-                        showMessage("Вы потопили " + s.name + " противника!");
+                        showMessage("Взрыв мины потопил " + s.name + " противника!");
                         break;
                     }
                 }
             }
-
-            // Ход остаётся у текущего игрока при попадании
+            recordShot(0, x, y, rules::ShotResult::MineHit, int(sizes.size()));
+            if (hits > 0) hitSound.play();
+            else missSound.play();
+            if (isGameOver(opponentFleet)) {
+                endGame(true);
+                return;
+            }
+            if (sizes.isEmpty()) showMessage("Вы попали в мину!", true);
+            myTurn = false;
+        }
+    }
+    else if (command == "READY") {
+        // Противник расставил флот; первым стреляет сервер, когда готовы оба.
+        // Режим залпов задаёт сервер: клиент переключается на режим из его READY
+        if (!isServer && (data == "salvo" || data == "classic") && (data == "salvo") != salvoMode) {
+            salvoMode = data == "salvo";
+            showMessage(salvoMode ? "Сервер играет залпами - режим залпов включён"
+                                  : "Сервер играет без залпов - режим залпов выключен", false);
+        }
+        peerReady = true;
+        if (isServer && !placing && !gameEnded) {
             myTurn = true;
+            showMessage("Противник готов! Ваш ход.", false);
         }
     }
+    else if (command == "SALVO") {
+        receiveSalvo(data);
+    }
+    else if (command == "SALVO_RESULT") {
+        applySalvoResult(data);
+    }
     else if (command == "MISS") {
         QStringList coords = data.split(',');
         if (coords.size() == 2) {
             int x = coords[0].toInt();
             int y = coords[1].toInt();
             opponentGrid[x][y] = Miss;
+            awaitingReply = false;
+            recordShot(0, x, y, rules::ShotResult::Miss, 0);
             missSound.play();
             showMessage("Вы промахнулись!", true);
             myTurn = false; // Передаём ход противнику
         }
     }
+
+    maybeRequestMove();
 }
 void BattleShipGame::newConnection() {
     if (server && server->hasPendingConnections()) {
@@ -389,6 +694,7 @@ void BattleShipGame::newConnection() {
                 this, &BattleShipGame::connectionError);
 
         showMessage("Игрок подключен! Расставьте корабли.", false);
+        if (autoPlay) autoPlaceFleet();
     }
 }
 
@@ -403,7 +709,9 @@ void BattleShipGame::readData() {
 }
 
 void BattleShipGame::disconnected() {
+    if (moveProvider) moveProvider->cancel();
     showMessage("Соединение разорвано. Игра завершена.", false);
+    if (!gameEnded) finishRecording(-1);
     gameEnded = true;
     if (socket) socket->deleteLater();
     if (server) server->close();
@@ -429,74 +737,23 @@ bool BattleShipGame::isInside(int x, int y) {
 }
 
 bool BattleShipGame::isSurroundingClear(Grid& grid, int x, int y, int size, bool horizontal) {
-    for (int i = -1; i <= size; ++i) {
-        for (int j = -1; j <= 1; ++j) {
-            int nx = x + (horizontal ? i : j);
-            int ny = y + (horizontal ? j : i);
-            if (isInside(nx, ny) && grid[nx][ny] != Empty && grid[nx][ny] != Mine) // Игнорируем мины
-                return false;
-        }
-    }
-    return true;
+    return rules::isSurroundingClear(grid, x, y, size, horizontal);
 }
 
 bool BattleShipGame::canPlace(Grid& grid, int x, int y, int size, bool horizontal) {
-    for (int i = 0; i < size; ++i) {
-        int px = x + (horizontal ? i : 0);
-        int py = y + (horizontal ? 0 : i);
-        if (!isInside(px, py) || (grid[px][py] != Empty && grid[px][py] != Mine)) // Разрешаем ставить на мины
-            return false;
-    }
-    return true; // Убрали проверку окружения, чтобы можно было ставить рядом с минами
+    return rules::canPlace(grid, x, y, size, horizontal); // Рядом с минами ставить можно
 }
 
 void BattleShipGame::placeShip(Grid& grid, int x, int y, int size, bool horizontal) {
-    for (int i = 0; i < size; ++i) {
-        int px = x + (horizontal ? i : 0);
-        int py = y + (horizontal ? 0 : i);
-        grid[px][py] = Ship; // Если здесь была мина, она будет заменена на корабль
-    }
+    rules::placeShip(grid, x, y, size, horizontal);
 }
 
 std::vector<std::pair<int, int>> BattleShipGame::getShipCells(const Grid& grid, int x, int y) {
-    std::vector<std::pair<int, int>> cells;
-    if (grid[x][y] != Hit) return cells;
-
-    int startX = x;
-    while (startX > 0 && grid[startX - 1][y] == Hit) --startX;
-    int endX = x;
-    while (endX + 1 < gridSize && grid[endX + 1][y] == Hit) ++endX;
-    if (endX - startX >= 1) {
-        for (int i = startX; i <= endX; ++i) cells.emplace_back(i, y);
-        return cells;
-    }
-
-    int startY = y;
-    while (startY > 0 && grid[x][startY - 1] == Hit) --startY;
-    int endY = y;
-    while (endY + 1 < gridSize && grid[x][endY + 1] == Hit) ++endY;
-    if (endY - startY >= 1) {
-        for (int i = startY; i <= endY; ++i) cells.emplace_back(x, i);
-        return cells;
-    }
-
-    cells.emplace_back(x, y);
-    return cells;
+    return rules::getShipCells(grid, x, y);
 }
 
 bool BattleShipGame::isShipSunk(const Grid& grid, int x, int y) {
-    auto cells = getShipCells(grid, x, y);
-    for (auto& [cx, cy] : cells) {
-        for (int dx = -1; dx <= 1; ++dx) {
-            for (int dy = -1; dy <= 1; ++dy) {
-                if (abs(dx) + abs(dy) != 1) continue;
-                int nx = cx + dx, ny = cy + dy;
-                if (isInside(nx, ny) && grid[nx][ny] == Ship)
-                    return false;
-            }
-        }
-    }
-    return true;
+    return rules::isShipSunk(grid, x, y);
 }
 
 void BattleShipGame::drawGrid(int offsetX, int offsetY, const Grid& grid,
@@ -622,7 +879,17 @@ void BattleShipGame::drawGrids() {
     drawGrid(spacing, spacing, playerGrid, playerFleet, true, "Игрок");
 
     // Рисуем поле противника (правое)
-    drawGrid(spacing * 2 + gridWidth, spacing, opponentGrid, opponentFleet, false, "Противник");
+    drawGrid(spacing * 2 + gridWidth, spacing, opponentGrid, opponentFleet, false,
+             vsComputer ? "Компьютер" : "Противник");
+
+    // Выбранные, но ещё не отправленные клетки залпа
+    for (auto [x, y] : salvoTargets) {
+        QGraphicsRectItem *mark = new QGraphicsRectItem(0, 0, cellSize - 2, cellSize - 2);
+        mark->setPos(spacing * 2 + gridWidth + x * cellSize, spacing + y * cellSize);
+        mark->setBrush(QBrush(COLOR_PREVIEW));
+        mark->setPen(QPen(COLOR_TITLE, 2));
+        scene->addItem(mark);
+    }
 
     if (placing && currentShipIndex < playerFleet.size()) {
         QPoint mousePos = mapFromGlobal(QCursor::pos());
@@ -702,6 +969,8 @@ void BattleShipGame::hideMessage() {
 
 void BattleShipGame::endGame(bool winner) {
     gameEnded = true;
+    if (moveProvider) moveProvider->cancel();
+    finishRecording(winner ? 0 : 1);
     if (winner) {
         showMessage("Поздравляем! Вы выиграли!", false);
         winSound.play();
@@ -728,23 +997,13 @@ void BattleShipGame::mousePressEvent(QMouseEvent *event) {
                     ship.count--;
                     if (ship.count == 0) currentShipIndex++;
                     if (currentShipIndex >= playerFleet.size()) {
-                        placing = false;
-                        if (socket && socket->state() == QAbstractSocket::ConnectedState) {
-                            sendMessage("READY:");
-                            if (isServer) {
-                                myTurn = true;
-                                showMessage("Игра началась! Ваш ход.", false);
-                            } else {
-                                myTurn = false;
-                                showMessage("Игра началась! Ожидаем ход противника...", false);
-                            }
-                        }
+                        finishPlacement();
                     }
                     drawGrids();
                 }
             }
         }
-    } else if (myTurn && !placing) {
+    } else if (myTurn && !placing && !autoPlay) {
         if (event->button() == Qt::LeftButton) {
             QPointF pos = mapToScene(event->pos());
             int playerGridWidth = gridSize * cellSize;
@@ -752,39 +1011,345 @@ void BattleShipGame::mousePressEvent(QMouseEvent *event) {
             int mx = (pos.x() - opponentGridStartX) / cellSize;
             int my = (pos.y() - 50) / cellSize;
 
-            if (mx >= 0 && mx < gridSize && my >= 0 && my < gridSize) {
-                // Проверяем, что по этой клетке ещё не стреляли
-                if (opponentGrid[mx][my] == Empty || opponentGrid[mx][my] == Mine) {
-                    if (socket && socket->state() == QAbstractSocket::ConnectedState) {
-                        // Запоминаем координаты выстрела
-                        lastShotX = mx;
-                        lastShotY = my;
-
-                        if (opponentGrid[mx][my] == Mine) {
-                            // Обработка попадания в мину
-                            hitSound.play();
-                            sendMessage("MINE:" + QString::number(mx) + "," + QString::number(my));
-                        } else {
-                            // Обычный выстрел
-                            sendMessage("SHOT:" + QString::number(mx) + "," + QString::number(my));
-                        }
+            fireAtOpponent(mx, my);
+        }
+    }
+}
 
-                        // Не меняем ход здесь - дождёмся ответа от противника
-                        showMessage("Ожидаем ответ противника...", false);
-                        drawGrids();
-                    } else {
-                        showMessage("Нет подключения к противнику!", true);
-                    }
-                } else {
-                    showMessage("Вы уже стреляли в эту клетку!", true);
-                }
+void BattleShipGame::fireAtOpponent(int mx, int my) {
+    if (awaitingReply) {
+        showMessage("Ожидаем ответ противника...", false);
+        return;
+    }
+
+    if (mx >= 0 && mx < gridSize && my >= 0 && my < gridSize) {
+        // Проверяем, что по этой клетке ещё не стреляли
+        if (opponentGrid[mx][my] == Empty) {
+            if (salvoMode) {
+                selectSalvoTarget(mx, my);
+            } else if (vsComputer) {
+                playerShotAtComputer(mx, my);
+            } else if (socket && socket->state() == QAbstractSocket::ConnectedState) {
+                // Запоминаем координаты выстрела; мину, если она там, найдёт противник
+                lastShotX = mx;
+                lastShotY = my;
+                sendMessage("SHOT:" + QString::number(mx) + "," + QString::number(my));
+
+                // Не меняем ход здесь - дождёмся ответа от противника
+                awaitingReply = true;
+                showMessage("Ожидаем ответ противника...", false);
+                drawGrids();
             } else {
-                showMessage("Выстрел за пределы поля!", true);
+                showMessage("Нет подключения к противнику!", true);
+            }
+        } else {
+            showMessage("Вы уже стреляли в эту клетку!", true);
+        }
+    } else {
+        showMessage("Выстрел за пределы поля!", true);
+    }
+}
+
+void BattleShipGame::finishPlacement() {
+    placing = false;
+    BotMoveProvider *bot = qobject_cast<BotMoveProvider *>(moveProvider);
+    if (vsComputer && bot && bot->isPlacing()) {
+        // Партию начнёт onBotPlacement, когда бот расставит свой флот
+        showMessage("Компьютер расставляет корабли...", false);
+        return;
+    }
+    if (vsComputer) {
+        myTurn = true;
+        showMessage("Игра началась! Ваш ход.", false);
+    } else if (socket && socket->state() == QAbstractSocket::ConnectedState) {
+        sendMessage(QString("READY:") + (salvoMode ? "salvo" : "classic"));
+        if (isServer && peerReady) {
+            myTurn = true;
+            showMessage("Игра началась! Ваш ход.", false);
+        } else if (isServer) {
+            // Стрелять можно только по расставленному флоту: ход придёт с READY противника
+            myTurn = false;
+            showMessage("Ожидаем расстановки кораблей противника...", false);
+        } else {
+            myTurn = false;
+            showMessage("Игра началась! Ожидаем ход противника...", false);
+        }
+    } else {
+        return;
+    }
+
+    recording.begin(gridSize, minesEnabled, vsComputer || isServer ? 0 : 1,
+                    uint32_t(QDateTime::currentSecsSinceEpoch()));
+    recording.setBoard(0, playerGrid);
+    if (vsComputer) recording.setBoard(1, computerGrid);
+    opponentRecordBoard.assign(gridSize, std::vector<Cell>(gridSize, Empty));
+    maybeRequestMove();
+}
+
+void BattleShipGame::recordShot(int player, int x, int y, rules::ShotResult::Kind kind, int sunkCount) {
+    if (!recording.isActive() || !isInside(x, y)) return;
+
+    // Исход каждого выстрела приходит одним сообщением, поэтому выстрел пишется один раз
+    recording.addShot({uint8_t(player), uint8_t(x), uint8_t(y), kind, uint8_t(sunkCount)});
+
+    if (player == 0 && !vsComputer) {
+        if (kind == rules::ShotResult::Hit) opponentRecordBoard[x][y] = Ship;
+        else if (kind == rules::ShotResult::MineHit) opponentRecordBoard[x][y] = Mine;
+    }
+}
+
+void BattleShipGame::finishRecording(int winner) {
+    if (!recording.isActive()) return;
+    // Сетевой противник свои корабли не раскрывает: пишем то, что нашли
+    if (!vsComputer) recording.setBoard(1, opponentRecordBoard, true);
+    recordWriter->append(recording.finish(winner));
+}
+
+int BattleShipGame::salvoShots(const std::vector<ShipInfo>& shooterFleet, const Grid& target) const {
+    int open = 0;
+    for (const auto& column : target)
+        for (Cell c : column)
+            if (c != Hit && c != Miss) ++open;
+    return std::min(rules::salvoSize(int(remainingShipSizes(shooterFleet).size())), open);
+}
+
+void BattleShipGame::selectSalvoTarget(int x, int y) {
+    // Повторный щелчок снимает клетку с залпа
+    auto it = std::find(salvoTargets.begin(), salvoTargets.end(), std::make_pair(x, y));
+    if (it != salvoTargets.end()) salvoTargets.erase(it);
+    else salvoTargets.emplace_back(x, y);
+
+    const int shots = salvoShots(playerFleet, opponentGrid);
+    if (int(salvoTargets.size()) >= shots) {
+        fireSalvo();
+        return;
+    }
+    showMessage(QString("Залп: выбрано %1 из %2").arg(salvoTargets.size()).arg(shots), false);
+}
+
+void BattleShipGame::fireSalvo() {
+    if (vsComputer) {
+        // Против компьютера залп разбирается сразу, ответ - та же строка, что пришла бы по сети
+        std::vector<rules::ShotResult> results = rules::resolveSalvo(computerGrid, salvoTargets);
+        applySalvoResult(encodeSalvoResult(salvoTargets, results));
+    } else if (socket && socket->state() == QAbstractSocket::ConnectedState) {
+        sendMessage("SALVO:" + encodeSalvo(salvoTargets));
+        awaitingReply = true;
+        showMessage("Залп отправлен. Ожидаем ответ противника...", false);
+    } else {
+        salvoTargets.clear();
+        showMessage("Нет подключения к противнику!", true);
+    }
+}
+
+void BattleShipGame::receiveSalvo(const QString& data) {
+    // Лишние выстрелы сверх числа кораблей противника и клетки вне поля не принимаем
+    std::vector<std::pair<int, int>> shots;
+    const int allowed = salvoShots(opponentFleet, playerGrid);
+    for (auto [x, y] : decodeSalvo(data)) {
+        if (isInside(x, y) && int(shots.size()) < allowed) shots.emplace_back(x, y);
+    }
+
+    std::vector<rules::ShotResult> results = rules::resolveSalvo(playerGrid, shots);
+    int hits = 0;
+    for (size_t i = 0; i < shots.size(); ++i) {
+        const rules::ShotResult& r = results[i];
+        recordShot(1, shots[i].first, shots[i].second, r.kind, int(r.sunkShips.size()));
+        if (vsComputer && moveProvider) moveProvider->shotResult(shots[i].first, shots[i].second, r);
+        hits += int(r.shipCellsHit.size());
+        for (const auto& cells : r.sunkShips) {
+            for (auto& s : playerFleet) {
+                if (s.remaining > 0 && s.size == (int)cells.size()) {
+                    s.remaining--;
+                    break;
+                }
+            }
+        }
+    }
+    sendMessage("SALVO_RESULT:" + encodeSalvoResult(shots, results));
+
+    if (hits > 0) hitSound.play();
+    else missSound.play();
+    if (isGameOver(playerFleet)) {
+        endGame(false);
+        return;
+    }
+    myTurn = true;
+    showMessage(QString("Залп противника: попаданий %1. Ваш залп - %2 выстр.")
+                    .arg(hits).arg(salvoShots(playerFleet, opponentGrid)), false);
+}
+
+void BattleShipGame::applySalvoResult(const QString& data) {
+    awaitingReply = false;
+    salvoTargets.clear();
+
+    int hits = 0, sunk = 0;
+    for (const QString& entry : data.split(';', Qt::SkipEmptyParts)) {
+        QStringList f = entry.split(',');
+        if (f.size() < 5 || f[2].isEmpty()) continue;
+        int x = f[0].toInt();
+        int y = f[1].toInt();
+        if (!isInside(x, y)) continue;
+
+        rules::ShotResult::Kind kind = rules::ShotResult::Repeat;
+        const QChar outcome = f[2][0];
+        if (outcome == QLatin1Char('H')) {
+            kind = rules::ShotResult::Hit;
+            opponentGrid[x][y] = Hit;
+            ++hits;
+        } else if (outcome == QLatin1Char('M')) {
+            kind = rules::ShotResult::Miss;
+            opponentGrid[x][y] = Miss;
+        } else if (outcome == QLatin1Char('X')) {
+            kind = rules::ShotResult::MineHit;
+            hits += revealMineBlast(x, y, f[3].toInt());
+        }
+
+        const QStringList sizes = f[4].split('/', Qt::SkipEmptyParts);
+        for (const QString& sizeText : sizes) {
+            int size = sizeText.toInt();
+            markOpponentSunk(x, y, size);
+            for (auto& s : opponentFleet) {
+                if (s.remaining > 0 && s.size == size) {
+                    s.remaining--;
+                    ++sunk;
+                    break;
+                }
             }
         }
+        recordShot(0, x, y, kind, int(sizes.size()));
+    }
+
+    if (hits > 0) hitSound.play();
+    else missSound.play();
+    if (isGameOver(opponentFleet)) {
+        endGame(true);
+        return;
+    }
+    myTurn = false;
+    showMessage(QString("Залп: попаданий %1, потоплено %2. Ходит противник...").arg(hits).arg(sunk), false);
+    if (vsComputer) {
+        QTimer::singleShot(600, this, &BattleShipGame::computerTurn);
     }
 }
+
+int BattleShipGame::revealMineBlast(int x, int y, int mask) {
+    // Как в rules::resolveShot: клетка мины и пустые соседи - промахи, маска говорит, где были корабли
+    int hits = 0;
+    opponentGrid[x][y] = Miss;
+    for (int dx = -1; dx <= 1; ++dx) {
+        for (int dy = -1; dy <= 1; ++dy) {
+            int nx = x + dx, ny = y + dy;
+            if ((dx == 0 && dy == 0) || !isInside(nx, ny)) continue;
+            if (mask & (1 << rules::mineBlastBit(dx, dy))) {
+                opponentGrid[nx][ny] = Hit;
+                if (recording.isActive()) opponentRecordBoard[nx][ny] = Ship;
+                ++hits;
+            } else if (opponentGrid[nx][ny] == Empty || opponentGrid[nx][ny] == Mine) {
+                opponentGrid[nx][ny] = Miss;
+            }
+        }
+    }
+    return hits;
+}
+
+void BattleShipGame::markOpponentSunk(int x, int y, int size) {
+    // Потопленный корабль ищем среди открытых клеток выстрела и соседних (для мины)
+    for (int dx = -1; dx <= 1; ++dx) {
+        for (int dy = -1; dy <= 1; ++dy) {
+            int nx = x + dx, ny = y + dy;
+            if (!isInside(nx, ny) || opponentGrid[nx][ny] != Hit || opponentSunk[nx][ny]) continue;
+            auto cells = getShipCells(opponentGrid, nx, ny);
+            if ((int)cells.size() != size) continue;
+            for (auto& [cx, cy] : cells) opponentSunk[cx][cy] = true;
+            return;
+        }
+    }
+}
+
+void BattleShipGame::autoPlaceFleet() {
+    if (!placing) return;
+
+    BotMoveProvider *bot = qobject_cast<BotMoveProvider *>(moveProvider);
+    if (bot) {
+        if (!bot->isPlacing()) bot->requestPlacement(playerGrid, remainingShipSizes(playerFleet));
+        showMessage("Бот расставляет корабли...", false);
+        return;
+    }
+    placeFleetRandomly(playerGrid, playerFleet);
+    completeAutoPlacement();
+}
+
+void BattleShipGame::onBotPlacement(bool placed, const Grid& grid) {
+    // Не ответивший или нарушивший правила бот заменяется случайной расстановкой
+    if (vsComputer) {
+        if (placed) computerGrid = grid;
+        else placeFleetRandomly(computerGrid, opponentFleet);
+        if (!placing) finishPlacement();
+        drawGrids();
+        return;
+    }
+    if (!placing) return;
+    if (placed) playerGrid = grid;
+    else placeFleetRandomly(playerGrid, playerFleet);
+    completeAutoPlacement();
+}
+
+void BattleShipGame::completeAutoPlacement() {
+    for (auto& s : playerFleet) s.count = 0;
+    currentShipIndex = playerFleet.size();
+    finishPlacement();
+    drawGrids();
+}
+
+BoardKnowledge BattleShipGame::opponentKnowledge() const {
+    return BoardKnowledge::fromGrid(opponentGrid, remainingShipSizes(opponentFleet),
+                                    [this](int x, int y) { return opponentSunk[x][y]; });
+}
+
+void BattleShipGame::maybeRequestMove() {
+    if (!autoPlay || vsComputer || !moveProvider) return;
+    if (gameEnded || placing || !myTurn || awaitingReply || moveProvider->isThinking()) return;
+
+    BoardKnowledge knowledge = opponentKnowledge();
+    for (auto [x, y] : salvoTargets) knowledge.excluded[y] |= uint64_t(1) << x;
+    moveProvider->requestMove(knowledge);
+}
+
+void BattleShipGame::onEngineMove(int x, int y) {
+    if (gameEnded || x < 0) return;
+
+    if (vsComputer) {
+        if (myTurn) return;
+        if (salvoMode) {
+            // Компьютер набирает залп по одной клетке и стреляет им через тот же SALVO, что и сеть
+            computerSalvo.emplace_back(x, y);
+            if (int(computerSalvo.size()) < salvoShots(opponentFleet, playerGrid)) {
+                computerTurn();
+                return;
+            }
+            std::vector<std::pair<int, int>> salvo;
+            salvo.swap(computerSalvo);
+            processCommand("SALVO", encodeSalvo(salvo));
+            return;
+        }
+        processCommand("SHOT", QString::number(x) + "," + QString::number(y));
+
+        // При попадании компьютер стреляет снова
+        if (!gameEnded && !myTurn) {
+            QTimer::singleShot(600, this, &BattleShipGame::computerTurn);
+        }
+    } else if (autoPlay && myTurn) {
+        fireAtOpponent(x, y);
+        // Следующая клетка залпа; после отправки залпа запрос не уйдёт - ждём ответа
+        if (salvoMode) maybeRequestMove();
+    }
+}
+
 void BattleShipGame::cancelConnection() {
+    if (moveProvider) moveProvider->cancel();
+    awaitingReply = false;
+    peerReady = false;
     if (socket) {
         socket->abort();  // Принудительно разрываем соединение
         socket->deleteLater();
@@ -8,6 +8,7 @@
 #include <QTcpServer>
 #include <QTcpSocket>
 #include <vector>
+#include <random>
 #include <QDialog>
 #include <QVBoxLayout>
 #include <QGroupBox>
@@ -16,6 +17,13 @@
 #include <QPushButton>
 #include <QtMultimedia/QSoundEffect>
 #include <QHBoxLayout>
+#include "gametypes.h"
+#include "boardknowledge.h"
+#include "moveprovider.h"
+#include "openingbook.h"
+#include "gamerecord.h"
+#include <QFile>
+#include <memory>
 
 enum GameSize { Size8x8 = 8, Size10x10 = 10, Size12x12 = 12 };
 
@@ -39,7 +47,8 @@ const QColor COLOR_GRID_LABELS(180, 180, 255);
 const QColor COLOR_WAITING(255, 165, 0);
 const QColor COLOR_MINE(255, 165, 0, 150);
 
-enum Cell { Empty, Ship, Hit, Miss, Mine };
+// Сколько ИИ думает над ходом, мс
+const int AI_TIME_BUDGET_MS = 300;
 
 struct ShipInfo {
     int size;
@@ -48,8 +57,6 @@ struct ShipInfo {
     QString name;
 };
 
-using Grid = std::vector<std::vector<Cell>>;
-
 class BattleShipGame : public QGraphicsView {
     Q_OBJECT
 public:
@@ -71,6 +78,8 @@ private slots:
     void readData();
     void disconnected();
     void connectionError(QAbstractSocket::SocketError socketError);
+    void onEngineMove(int x, int y);
+    void onBotPlacement(bool placed, const Grid& grid);
 
 private:
     int lastShotX = -1;
@@ -97,6 +106,40 @@ private:
     bool minesEnabled;
     int minesCount;
 
+    // Игра против компьютера
+    bool vsComputer;
+    Grid computerGrid;
+
+    // ИИ считает ходы в отдельном потоке; autoPlay - он же стреляет за игрока по сети
+    MoveProvider *moveProvider;
+    bool useMonteCarlo;
+    // Команда запуска внешнего бота (botprotocol.h); пусто - встроенный ИИ
+    QString botCommand;
+    bool autoPlay;
+    bool awaitingReply;
+    // Противник прислал READY: его флот расставлен, по нему можно стрелять
+    bool peerReady = false;
+    std::vector<std::vector<bool>> opponentSunk;
+
+    // Режим залпов: за ход столько выстрелов, сколько у стреляющего кораблей на плаву.
+    // Клетки залпа уходят одним сообщением SALVO, исходы приходят одним SALVO_RESULT
+    bool salvoMode = false;
+    std::vector<std::pair<int, int>> salvoTargets;      // наш залп, пока выбираются клетки
+    std::vector<std::pair<int, int>> computerSalvo;     // залп компьютера, пока ИИ выбирает клетки
+
+    // Дебютная книга отображается в память при запуске; файл держим открытым, пока она нужна
+    QFile bookFile;
+    OpeningBook openingBook;
+
+    // Запись партии: сторона 0 - мы. Поле сетевого противника собирается по ответам
+    // на наши выстрелы; в архив запись уходит целиком в конце партии
+    GameRecordBuilder recording;
+    std::unique_ptr<RecordWriter> recordWriter;
+    Grid opponentRecordBoard;
+
+    // Один генератор на всю игру: мины и расстановка компьютера берут числа из него
+    std::mt19937 rng;
+
     QTcpServer *server;
     QTcpSocket *socket;
     bool isServer;
@@ -118,8 +161,31 @@ private:
     bool isGameOver(const std::vector<ShipInfo>& fleetInfo);
     void showMessage(const QString& message, bool timeout = true);
     void startNetworkGame(bool asServer);
+    void startFreeForAll();
     void endGame(bool winner);
     void showGameOptions();
+    void setupComputerOpponent();
+    void placeFleetRandomly(Grid& grid, const std::vector<ShipInfo>& fleet);
+    void playerShotAtComputer(int x, int y);
+    void computerTurn();
+    void fireAtOpponent(int x, int y);
+    void finishPlacement();
+    void autoPlaceFleet();
+    void completeAutoPlacement();
+    void maybeRequestMove();
+    void loadOpeningBook();
+    void recordShot(int player, int x, int y, rules::ShotResult::Kind kind, int sunkCount);
+    int salvoShots(const std::vector<ShipInfo>& shooterFleet, const Grid& target) const;
+    void selectSalvoTarget(int x, int y);
+    void fireSalvo();
+    void receiveSalvo(const QString& data);
+    void applySalvoResult(const QString& data);
+    // Ответ на выстрел в мину: открывает область 3x3 на поле противника, возвращает число попаданий
+    int revealMineBlast(int x, int y, int mask);
+    void markOpponentSunk(int x, int y, int size);
+    void finishRecording(int winner);
+    BoardKnowledge opponentKnowledge() const;
+    std::vector<int> remainingShipSizes(const std::vector<ShipInfo>& fleet) const;
 };
 
 #endif // BATTLESHIPGAME_H
@@ -0,0 +1,50 @@
+#include "boardknowledge.h"
+
+void BoardKnowledge::reset(int boardSize) {
+    size = boardSize;
+    miss.assign(boardSize, 0);
+    hit.assign(boardSize, 0);
+    sunk.assign(boardSize, 0);
+    excluded.assign(boardSize, 0);
+    remainingShips.clear();
+}
+
+bool BoardKnowledge::isKnown(int x, int y) const {
+    uint64_t bit = uint64_t(1) << x;
+    return ((miss[y] | hit[y] | sunk[y]) & bit) != 0;
+}
+
+bool BoardKnowledge::canShoot(int x, int y) const {
+    return !isKnown(x, y) && !((excluded[y] >> x) & 1);
+}
+
+int BoardKnowledge::knownCount() const {
+    int count = 0;
+    for (int y = 0; y < size; ++y) count += __builtin_popcountll(miss[y] | hit[y] | sunk[y]);
+    return count;
+}
+
+bool BoardKnowledge::hasOpenHits() const {
+    for (uint64_t r : hit)
+        if (r) return true;
+    return false;
+}
+
+BoardKnowledge BoardKnowledge::fromGrid(const Grid& grid, const std::vector<int>& remainingShips,
+                                        const std::function<bool(int, int)>& isSunk) {
+    BoardKnowledge k;
+    k.reset(int(grid.size()));
+    k.remainingShips = remainingShips;
+    for (int x = 0; x < k.size; ++x) {
+        for (int y = 0; y < k.size; ++y) {
+            uint64_t bit = uint64_t(1) << x;
+            if (grid[x][y] == Miss) {
+                k.miss[y] |= bit;
+            } else if (grid[x][y] == Hit) {
+                if (isSunk && isSunk(x, y)) k.sunk[y] |= bit;
+                else k.hit[y] |= bit;
+            }
+        }
+    }
+    return k;
+}
@@ -0,0 +1,39 @@
+// boardknowledge.h
+#ifndef BOARDKNOWLEDGE_H
+#define BOARDKNOWLEDGE_H
+
+#include "gametypes.h"
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Максимальная сторона поля, которую поддерживает битовое представление
+const int MAX_AI_BOARD_SIZE = 64;
+
+// Что известно стреляющему о поле противника.
+// Строка y хранится как битовая маска, бит x - клетка (x, y), как в grid[x][y].
+struct BoardKnowledge {
+    int size = 0;
+    std::vector<uint64_t> miss;  // промахи
+    std::vector<uint64_t> hit;   // попадания в ещё не потопленные корабли
+    std::vector<uint64_t> sunk;  // клетки потопленных кораблей
+    // Клетки, уже выбранные в текущий залп: стрелять в них снова нельзя,
+    // но корабли через них по-прежнему могут проходить
+    std::vector<uint64_t> excluded;
+    std::vector<int> remainingShips; // размеры ещё не потопленных кораблей
+
+    void reset(int boardSize);
+    bool isKnown(int x, int y) const;
+    // Клетка не открыта и не выбрана в текущий залп
+    bool canShoot(int x, int y) const;
+    // Сколько клеток уже открыто
+    int knownCount() const;
+    bool hasOpenHits() const;
+
+    // Строит знание по видимому полю: Miss - промах, Hit - попадание,
+    // isSunk решает, относится ли попадание к уже потопленному кораблю.
+    static BoardKnowledge fromGrid(const Grid& grid, const std::vector<int>& remainingShips,
+                                   const std::function<bool(int, int)>& isSunk);
+};
+
+#endif // BOARDKNOWLEDGE_H
@@ -0,0 +1,118 @@
+// Встроенный ИИ как внешний бот: пример и эталон протокола из botprotocol.h
+//   sea_bot [--engine heatmap|montecarlo] [--seed N]
+// Запускается хостом (игрой, sea_selfplay, sea_botcheck), читает команды из stdin.
+#include "battleshipai.h"
+#include "botprotocol.h"
+#include "montecarloai.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+
+namespace {
+
+void printUsage() {
+    std::printf("usage: sea_bot [--engine heatmap|montecarlo] [--seed N]\n"
+                "speaks the bot protocol on stdin/stdout; start it from a host, e.g.\n"
+                "  sea_selfplay --a bot=./sea_bot:bot=./sea_bot --b classic:heatmap\n");
+}
+
+// Запас на разбор команды и вывод ответа
+const int REPLY_MARGIN_MS = 10;
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    std::string engineName = "heatmap";
+    unsigned seed = std::random_device{}();
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || i + 1 >= argc) {
+            printUsage();
+            return arg == "--help" ? 0 : 1;
+        }
+        std::string value = argv[++i];
+        if (arg == "--engine" && (value == "heatmap" || value == "montecarlo")) engineName = value;
+        else if (arg == "--seed") seed = unsigned(std::strtoul(value.c_str(), nullptr, 10));
+        else {
+            std::fprintf(stderr, "bad argument: %s %s\n", arg.c_str(), value.c_str());
+            printUsage();
+            return 1;
+        }
+    }
+
+    std::ios::sync_with_stdio(false);
+    std::mt19937 rng(seed);
+    BattleShipAI heatMap(seed);
+    MonteCarloConfig mcConfig;
+    mcConfig.threads = 1;
+    mcConfig.seed = seed;
+    MonteCarloAI monteCarlo(mcConfig);
+
+    int size = 10;
+    std::vector<int> fleet = rules::shipSizes(rules::fleetFor(size));
+
+    // Ход в пределах movetime; время ограничивает и точный эндшпиль, и Монте-Карло
+    auto think = [&](const BoardKnowledge& k, int moveTimeMs) {
+        const int budget = std::max(1, moveTimeMs - REPLY_MARGIN_MS);
+        if (engineName == "montecarlo") {
+            monteCarlo.setTimeBudget(budget);
+            return monteCarlo.chooseShot(k);
+        }
+        EndgameConfig config = heatMap.endgameConfig();
+        config.timeBudgetMs = budget;
+        heatMap.setEndgameConfig(config);
+        return heatMap.chooseShot(k);
+    };
+    auto bestMove = [](std::pair<int, int> shot) {
+        std::cout << "bestmove " << shot.first << ' ' << shot.second << '\n';
+    };
+    auto moveTime = [](const std::string& args) {
+        // "... movetime <ms>"; без него - секунда на ход
+        size_t at = args.find("movetime");
+        return at == std::string::npos ? 1000 : std::max(1, std::atoi(args.c_str() + at + 8));
+    };
+
+    BoardKnowledge position;
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        auto [cmd, args] = botproto::splitCommand(line);
+        if (cmd == "sbp") {
+            std::cout << "id name sea_bot " << engineName << "\nid author sea_fight\nsbpok" << std::endl;
+        } else if (cmd == "isready") {
+            std::cout << "readyok" << std::endl;
+        } else if (cmd == "newgame") {
+            int mines = 0;
+            if (!botproto::parseNewGame(args, size, mines, fleet)) std::cout << "info bad newgame" << std::endl;
+            heatMap.reseed(unsigned(rng()));
+            monteCarlo.reseed(rng());
+        } else if (cmd == "place") {
+            Grid grid(size, std::vector<Cell>(size, Empty));
+            rules::placeFleetRandomly(grid, fleet, rng);
+            std::cout << botproto::placementReply(grid) << std::endl;
+        } else if (cmd == "position") {
+            if (!botproto::parsePosition(args, position)) std::cout << "info bad position" << std::endl;
+        } else if (cmd == "go") {
+            bestMove(think(position, moveTime(args)));
+            std::cout.flush();
+        } else if (cmd == "batch") {
+            // Ответы копятся и уходят одной записью в конце пачки
+            const int count = std::atoi(args.c_str());
+            const int limit = moveTime(args);
+            for (int i = 0; i < count && std::getline(std::cin, line); ++i) {
+                auto [posCmd, posArgs] = botproto::splitCommand(line);
+                BoardKnowledge k;
+                if (posCmd == "position" && botproto::parsePosition(posArgs, k)) bestMove(think(k, limit));
+                else bestMove({-1, -1});
+            }
+            std::cout.flush();
+        } else if (cmd == "quit") {
+            break;
+        }
+        // result и stop: ход считается в этом же потоке, и к приходу stop он уже отправлен
+    }
+    return 0;
+}
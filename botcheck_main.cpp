@@ -0,0 +1,155 @@
+// Проверка внешнего бота и замер пропускной способности протокола:
+//   sea_botcheck --engine "python3 mybot.py" --positions 10000 --batch 256 --movetime 20
+// Бот получает случайные позиции из середины партий; считается, сколько его ходов
+// попадают в корабль, сколько ходов недопустимы и сколько позиций в секунду он разбирает.
+#include "botengine.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+
+namespace {
+
+void printUsage() {
+    std::printf("usage: sea_botcheck --engine command [--size 8|10|12] [--positions N]\n"
+                "                    [--batch N] [--movetime ms] [--seed N]\n");
+}
+
+struct Position {
+    Grid board;                 // скрытое поле: по нему проверяется, попал бы бот или нет
+    BoardKnowledge knowledge;
+};
+
+// Случайная позиция: флот расставлен, сделано случайное число случайных выстрелов
+Position randomPosition(int size, std::mt19937& rng) {
+    Position p;
+    p.board.assign(size, std::vector<Cell>(size, Empty));
+    const std::vector<int> sizes = rules::shipSizes(rules::fleetFor(size));
+    rules::placeFleetRandomly(p.board, sizes, rng);
+    p.knowledge.reset(size);
+    p.knowledge.remainingShips = sizes;
+
+    const int shots = std::uniform_int_distribution<int>(0, size * size / 2)(rng);
+    std::uniform_int_distribution<int> coord(0, size - 1);
+    for (int i = 0; i < shots && !p.knowledge.remainingShips.empty(); ++i) {
+        int x = coord(rng), y = coord(rng);
+        if (p.knowledge.isKnown(x, y)) continue;
+        rules::ShotResult shot = rules::resolveShot(p.board, x, y);
+        (shot.kind == rules::ShotResult::Hit ? p.knowledge.hit : p.knowledge.miss)[y] |= uint64_t(1) << x;
+        for (const auto& cells : shot.sunkShips) {
+            for (auto [cx, cy] : cells) {
+                p.knowledge.hit[cy] &= ~(uint64_t(1) << cx);
+                p.knowledge.sunk[cy] |= uint64_t(1) << cx;
+            }
+            auto& left = p.knowledge.remainingShips;
+            auto it = std::find(left.begin(), left.end(), int(cells.size()));
+            if (it != left.end()) left.erase(it);
+        }
+    }
+    return p;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    std::string command;
+    int size = 10;
+    size_t positions = 2000;
+    size_t batch = 64;
+    int moveTimeMs = 100;
+    unsigned seed = 1;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || i + 1 >= argc) {
+            printUsage();
+            return arg == "--help" ? 0 : 1;
+        }
+        std::string value = argv[++i];
+        if (arg == "--engine") command = value;
+        else if (arg == "--size") size = std::atoi(value.c_str());
+        else if (arg == "--positions") positions = std::strtoull(value.c_str(), nullptr, 10);
+        else if (arg == "--batch") batch = std::max<size_t>(1, std::strtoull(value.c_str(), nullptr, 10));
+        else if (arg == "--movetime") moveTimeMs = std::max(1, std::atoi(value.c_str()));
+        else if (arg == "--seed") seed = unsigned(std::strtoul(value.c_str(), nullptr, 10));
+        else {
+            std::fprintf(stderr, "bad argument: %s %s\n", arg.c_str(), value.c_str());
+            printUsage();
+            return 1;
+        }
+    }
+    if (command.empty()) {
+        printUsage();
+        return 1;
+    }
+    if (size != 8 && size != 10 && size != 12) {
+        std::fprintf(stderr, "size must be 8, 10 or 12\n");
+        return 1;
+    }
+
+    BotEngine engine(command);
+    const std::vector<int> fleet = rules::shipSizes(rules::fleetFor(size));
+    if (!engine.newGame(size, 0, fleet)) {
+        std::fprintf(stderr, "cannot start '%s': %s\n", command.c_str(), engine.error().c_str());
+        return 1;
+    }
+    std::printf("bot: %s\n", engine.name().c_str());
+
+    // Расстановка: каждый ответ place проверяется по правилам хоста
+    int legalPlacements = 0;
+    const int placements = 20;
+    for (int i = 0; i < placements; ++i) {
+        Grid grid(size, std::vector<Cell>(size, Empty));
+        if (engine.place(grid, fleet)) ++legalPlacements;
+        else if (!engine.isRunning()) break;
+    }
+    std::printf("placements: %d/%d legal\n", legalPlacements, placements);
+    if (!engine.isRunning() && !engine.newGame(size, 0, fleet)) {
+        std::fprintf(stderr, "bot died: %s\n", engine.error().c_str());
+        return 1;
+    }
+
+    std::mt19937 rng(seed);
+    std::vector<Position> all;
+    all.reserve(positions);
+    for (size_t i = 0; i < positions; ++i) all.push_back(randomPosition(size, rng));
+
+    size_t answered = 0, illegal = 0, hits = 0;
+    std::vector<BoardKnowledge> request;
+    std::vector<std::pair<int, int>> shots;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t first = 0; first < all.size() && engine.isRunning(); first += batch) {
+        const size_t count = std::min(batch, all.size() - first);
+        request.clear();
+        for (size_t i = 0; i < count; ++i) request.push_back(all[first + i].knowledge);
+        engine.chooseShots(request, moveTimeMs, shots);
+
+        for (size_t i = 0; i < count; ++i) {
+            auto [x, y] = shots[i];
+            const Position& p = all[first + i];
+            if (x < 0 && y < 0) continue;
+            ++answered;
+            if (x >= size || y >= size || x < 0 || y < 0 || p.knowledge.isKnown(x, y)) ++illegal;
+            else if (p.board[x][y] == Ship) ++hits;
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("positions: %zu, answered %zu, illegal %zu, timeouts %d\n",
+                all.size(), answered, illegal, engine.timeouts());
+    // Для сравнения: доля кораблей среди неоткрытых клеток - попадания наугад
+    double baseline = 0;
+    for (const Position& p : all) {
+        int ships = 0;
+        for (const auto& column : p.board) ships += int(std::count(column.begin(), column.end(), Ship));
+        baseline += double(ships) / std::max(1, size * size - p.knowledge.knownCount());
+    }
+    std::printf("hit rate: %.2f%% (random unknown cell: %.2f%%)\n",
+                answered ? 100.0 * hits / answered : 0.0, all.empty() ? 0.0 : 100.0 * baseline / all.size());
+    std::printf("%.2f s, %.0f positions/s in batches of %zu\n", seconds,
+                seconds > 0 ? all.size() / seconds : 0.0, batch);
+    if (!engine.isRunning()) std::fprintf(stderr, "bot died: %s\n", engine.error().c_str());
+    return engine.isRunning() && illegal == 0 ? 0 : 2;
+}
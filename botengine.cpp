@@ -0,0 +1,253 @@
+#include "botengine.h"
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <mutex>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+BotEngine::BotEngine(std::string command) : command(command), botName(std::move(command)) {}
+
+BotEngine::~BotEngine() {
+    if (isRunning()) send("quit\n");
+    stopProcess();
+}
+
+bool BotEngine::fail(const std::string& message) {
+    lastError = message;
+    return false;
+}
+
+#ifdef _WIN32
+
+bool BotEngine::start() { return fail("external bots need a POSIX host"); }
+bool BotEngine::send(const std::string&) { return false; }
+bool BotEngine::readLine(std::string&, Clock::time_point) { return false; }
+void BotEngine::stopProcess() {}
+
+#else
+
+bool BotEngine::start() {
+    if (isRunning()) return true;
+
+    // Каналы одного бота не должны достаться другим, запущенным из соседних потоков.
+    // Между pipe() и FD_CLOEXEC чужой fork унёс бы их в своего бота, поэтому
+    // создание каналов и fork идут под общим замком
+    static std::mutex spawnMutex;
+    std::unique_lock<std::mutex> spawnLock(spawnMutex);
+
+    int in[2], out[2];
+    if (pipe(in) != 0) return fail(std::strerror(errno));
+    if (pipe(out) != 0) {
+        close(in[0]);
+        close(in[1]);
+        return fail(std::strerror(errno));
+    }
+    for (int fd : {in[0], in[1], out[0], out[1]}) fcntl(fd, F_SETFD, FD_CLOEXEC);
+    // Умерший бот не должен ронять хост сигналом при записи в канал
+    std::signal(SIGPIPE, SIG_IGN);
+
+    pid = fork();
+    if (pid < 0) {
+        for (int fd : {in[0], in[1], out[0], out[1]}) close(fd);
+        return fail(std::strerror(errno));
+    }
+    if (pid == 0) {
+        dup2(in[0], STDIN_FILENO);
+        dup2(out[1], STDOUT_FILENO);
+        execl("/bin/sh", "sh", "-c", command.c_str(), static_cast<char *>(nullptr));
+        _exit(127);
+    }
+    spawnLock.unlock();
+
+    close(in[0]);
+    close(out[1]);
+    toBot = in[1];
+    fromBot = out[0];
+    fcntl(toBot, F_SETFL, fcntl(toBot, F_GETFL) | O_NONBLOCK);
+
+    std::string args;
+    if (!send("sbp\n") ||
+        !waitFor("sbpok", args, Clock::now() + std::chrono::milliseconds(botproto::HANDSHAKE_TIMEOUT_MS))) {
+        std::string reason = lastError.empty() ? "no sbpok from '" + command + "'" : lastError;
+        stopProcess();
+        return fail(reason);
+    }
+    return true;
+}
+
+bool BotEngine::send(const std::string& lines) {
+    if (!isRunning()) return false;
+    // Запись неблокирующая: длинную пачку бот читает, пока мы ждём его ответов в readLine
+    output += lines;
+    while (!output.empty()) {
+        ssize_t n = write(toBot, output.data(), output.size());
+        if (n > 0) {
+            output.erase(0, size_t(n));
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return true;
+        } else {
+            stopProcess();
+            return fail("bot closed its input");
+        }
+    }
+    return true;
+}
+
+bool BotEngine::readLine(std::string& line, Clock::time_point deadline) {
+    while (true) {
+        size_t newline = input.find('\n');
+        if (newline != std::string::npos) {
+            line.assign(input, 0, newline);
+            input.erase(0, newline + 1);
+            return true;
+        }
+        if (!isRunning()) return false;
+
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+        if (left <= 0) return fail("bot timed out");
+
+        pollfd fds[2] = {{fromBot, POLLIN, 0}, {toBot, POLLOUT, 0}};
+        int ready = poll(fds, output.empty() ? 1 : 2, int(std::min<long long>(left, 1000)));
+        if (ready < 0 && errno != EINTR) return fail(std::strerror(errno));
+        if (ready <= 0) continue;
+
+        if (!output.empty() && (fds[1].revents & (POLLOUT | POLLERR | POLLHUP))) {
+            if (!send(std::string())) return false;
+        }
+        if (fds[0].revents & (POLLIN | POLLHUP | POLLERR)) {
+            char chunk[4096];
+            ssize_t n = read(fromBot, chunk, sizeof(chunk));
+            if (n > 0) input.append(chunk, size_t(n));
+            else if (n == 0 || errno != EINTR) {
+                stopProcess();
+                return fail("bot exited");
+            }
+        }
+    }
+}
+
+void BotEngine::stopProcess() {
+    if (toBot >= 0) close(toBot);
+    if (fromBot >= 0) close(fromBot);
+    toBot = fromBot = -1;
+    output.clear();
+    input.clear();
+    if (pid <= 0) return;
+
+    // Закрытый stdin - сигнал боту завершиться; не завершился сам - добиваем
+    for (int i = 0; i < 20; ++i) {
+        if (waitpid(pid, nullptr, WNOHANG) == pid) {
+            pid = -1;
+            return;
+        }
+        usleep(10000);
+    }
+    kill(pid, SIGKILL);
+    waitpid(pid, nullptr, 0);
+    pid = -1;
+}
+
+#endif
+
+bool BotEngine::waitFor(const std::string& expected, std::string& args, Clock::time_point deadline) {
+    std::string line;
+    while (readLine(line, deadline)) {
+        auto [cmd, rest] = botproto::splitCommand(line);
+        if (cmd == expected) {
+            args = rest;
+            return true;
+        }
+        if (cmd == "id" && rest.compare(0, 5, "name ") == 0) botName = rest.substr(5);
+    }
+    return false;
+}
+
+bool BotEngine::resync() {
+    std::string args;
+    if (send("isready\n") &&
+        waitFor("readyok", args, Clock::now() + std::chrono::milliseconds(botproto::HANDSHAKE_TIMEOUT_MS)))
+        return true;
+    stopProcess();
+    return fail("bot stopped responding");
+}
+
+bool BotEngine::newGame(int size, int mines, const std::vector<int>& fleet) {
+    if (!start()) return false;
+    std::string args;
+    return send(botproto::newGameCommand(size, mines, fleet) + "\nisready\n") &&
+           waitFor("readyok", args, Clock::now() + std::chrono::milliseconds(botproto::HANDSHAKE_TIMEOUT_MS));
+}
+
+bool BotEngine::place(Grid& grid, const std::vector<int>& fleet) {
+    std::string args;
+    if (!send("place\n")) return false;
+    if (!waitFor("placement", args, Clock::now() + std::chrono::milliseconds(botproto::HANDSHAKE_TIMEOUT_MS))) {
+        if (isRunning() && resync()) fail("no placement");
+        return false;
+    }
+    return botproto::applyPlacement(args, fleet, grid) || fail("illegal placement: " + args);
+}
+
+bool BotEngine::chooseShot(const BoardKnowledge& knowledge, int moveTimeMs, std::pair<int, int>& shot) {
+    std::vector<std::pair<int, int>> shots;
+    if (!chooseShots({knowledge}, moveTimeMs, shots)) return false;
+    shot = shots[0];
+    return true;
+}
+
+bool BotEngine::chooseShots(const std::vector<BoardKnowledge>& positions, int moveTimeMs,
+                            std::vector<std::pair<int, int>>& shots) {
+    shots.assign(positions.size(), {-1, -1});
+    if (positions.empty()) return true;
+    if (!isRunning()) return fail("bot is not running");
+
+    // Одиночный ход - обычный go; пачка уходит одной записью
+    std::string request;
+    if (positions.size() == 1) {
+        request = botproto::positionCommand(positions[0]) + '\n' + botproto::goCommand(moveTimeMs) + '\n';
+    } else {
+        request = botproto::batchCommand(positions.size(), moveTimeMs) + '\n';
+        for (const BoardKnowledge& k : positions) request += botproto::positionCommand(k) + '\n';
+    }
+    if (!send(request)) return false;
+
+    auto deadline = Clock::now() + std::chrono::milliseconds(int64_t(moveTimeMs) * int64_t(positions.size()) +
+                                                             botproto::GRACE_MS);
+    size_t received = 0;
+    bool stopped = false;
+    std::string args;
+    while (received < positions.size()) {
+        if (waitFor("bestmove", args, deadline)) {
+            if (!botproto::parseBestMove(args, shots[received].first, shots[received].second))
+                shots[received] = {-1, -1};
+            ++received;
+            continue;
+        }
+        if (!isRunning()) return false;
+        if (stopped) break;
+        // Срок вышел: просим ответить сейчас и даём на это ещё немного времени
+        stopped = true;
+        ++timeoutCount;
+        if (!send("stop\n")) return false;
+        deadline = Clock::now() + std::chrono::milliseconds(botproto::GRACE_MS);
+    }
+
+    if (received < positions.size()) {
+        resync();
+        return fail("bot timed out");
+    }
+    return true;
+}
+
+void BotEngine::notifyResult(int x, int y, const rules::ShotResult& result) {
+    send(botproto::resultCommand(x, y, result) + '\n');
+}
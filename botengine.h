@@ -0,0 +1,63 @@
+// botengine.h
+#ifndef BOTENGINE_H
+#define BOTENGINE_H
+
+#include "botprotocol.h"
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Внешний бот для консольных инструментов (без Qt): дочерний процесс через
+// /bin/sh -c, каналы stdin/stdout и poll для сроков. Все вызовы синхронные,
+// один объект - из одного потока; симулятор держит по боту на поток.
+class BotEngine {
+public:
+    explicit BotEngine(std::string command);
+    ~BotEngine();
+
+    BotEngine(const BotEngine&) = delete;
+    BotEngine& operator=(const BotEngine&) = delete;
+
+    // Запуск и рукопожатие; повторный вызов ничего не делает
+    bool start();
+    bool isRunning() const { return pid > 0; }
+    const std::string& name() const { return botName; }
+    const std::string& error() const { return lastError; }
+
+    bool newGame(int size, int mines, const std::vector<int>& fleet);
+    // Расстановка ставится на grid, только если она допустима
+    bool place(Grid& grid, const std::vector<int>& fleet);
+    // false - бот не уложился в время или ответил не по протоколу
+    bool chooseShot(const BoardKnowledge& knowledge, int moveTimeMs, std::pair<int, int>& shot);
+    // Пачка независимых позиций одним запросом; ходы без ответа - (-1, -1)
+    bool chooseShots(const std::vector<BoardKnowledge>& positions, int moveTimeMs,
+                     std::vector<std::pair<int, int>>& shots);
+    void notifyResult(int x, int y, const rules::ShotResult& result);
+
+    int timeouts() const { return timeoutCount; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    std::string command;
+    std::string botName;
+    std::string lastError;
+    int pid = -1;
+    int toBot = -1;
+    int fromBot = -1;
+    std::string input;              // прочитано из канала, но ещё не разобрано по строкам
+    std::string output;             // ещё не записано в канал
+    int timeoutCount = 0;
+
+    bool send(const std::string& lines);
+    bool readLine(std::string& line, Clock::time_point deadline);
+    // Ждёт строку с командой expected, остальные пропускает
+    bool waitFor(const std::string& expected, std::string& args, Clock::time_point deadline);
+    // После просроченного хода: stop, затем isready - поздние bestmove отбрасываются
+    bool resync();
+    bool fail(const std::string& message);
+    void stopProcess();
+};
+
+#endif // BOTENGINE_H
@@ -0,0 +1,166 @@
+#include "botprotocol.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+
+namespace botproto {
+
+namespace {
+std::string joinSizes(const std::vector<int>& sizes, char separator) {
+    if (sizes.empty()) return "-";
+    std::string out;
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        if (i) out += separator;
+        out += std::to_string(sizes[i]);
+    }
+    return out;
+}
+
+bool parseSizes(const std::string& text, char separator, std::vector<int>& sizes) {
+    sizes.clear();
+    if (text == "-") return true;
+    std::istringstream in(text);
+    std::string item;
+    while (std::getline(in, item, separator)) {
+        int len = std::atoi(item.c_str());
+        if (len <= 0 || len > MAX_AI_BOARD_SIZE) return false;
+        sizes.push_back(len);
+    }
+    return !sizes.empty();
+}
+
+bool isShipCell(const Grid& grid, int x, int y) {
+    return rules::isInside(grid, x, y) && (grid[x][y] == Ship || grid[x][y] == Hit);
+}
+}
+
+std::string newGameCommand(int size, int mines, const std::vector<int>& fleet) {
+    return "newgame " + std::to_string(size) + ' ' + std::to_string(mines) + ' ' + joinSizes(fleet, ',');
+}
+
+std::string positionCommand(const BoardKnowledge& k) {
+    std::string line = "position " + std::to_string(k.size) + ' ';
+    line.reserve(line.size() + k.size * k.size + 32);
+    for (int y = 0; y < k.size; ++y) {
+        for (int x = 0; x < k.size; ++x) {
+            const uint64_t bit = uint64_t(1) << x;
+            line += (k.sunk[y] & bit) ? '#' : (k.hit[y] & bit) ? 'x' : (k.miss[y] & bit) ? 'o'
+                  : (k.excluded[y] & bit) ? '*' : '.';
+        }
+    }
+    return line + ' ' + joinSizes(k.remainingShips, ',');
+}
+
+std::string goCommand(int moveTimeMs) {
+    return "go movetime " + std::to_string(moveTimeMs);
+}
+
+std::string batchCommand(size_t count, int moveTimeMs) {
+    return "batch " + std::to_string(count) + " movetime " + std::to_string(moveTimeMs);
+}
+
+std::string resultCommand(int x, int y, const rules::ShotResult& result) {
+    const char kind = result.kind == rules::ShotResult::Miss ? 'M' : result.kind == rules::ShotResult::Hit ? 'H'
+                    : result.kind == rules::ShotResult::MineHit ? 'X' : 'R';
+    std::vector<int> sunk;
+    for (const auto& cells : result.sunkShips) sunk.push_back(int(cells.size()));
+    return "result " + std::to_string(x) + ' ' + std::to_string(y) + ' ' + kind + ' ' + joinSizes(sunk, '/');
+}
+
+std::pair<std::string, std::string> splitCommand(const std::string& line) {
+    size_t begin = line.find_first_not_of(" \t\r");
+    if (begin == std::string::npos) return {};
+    size_t end = line.find_first_of(" \t\r", begin);
+    if (end == std::string::npos) return {line.substr(begin), std::string()};
+    size_t args = line.find_first_not_of(" \t\r", end);
+    size_t last = line.find_last_not_of(" \t\r");
+    return {line.substr(begin, end - begin),
+            args == std::string::npos ? std::string() : line.substr(args, last + 1 - args)};
+}
+
+bool parseBestMove(const std::string& args, int& x, int& y) {
+    std::istringstream in(args);
+    return bool(in >> x >> y);
+}
+
+bool parseNewGame(const std::string& args, int& size, int& mines, std::vector<int>& fleet) {
+    std::istringstream in(args);
+    std::string sizes;
+    if (!(in >> size >> mines >> sizes)) return false;
+    return size > 0 && size <= MAX_AI_BOARD_SIZE && mines >= 0 && parseSizes(sizes, ',', fleet);
+}
+
+bool parsePosition(const std::string& args, BoardKnowledge& k) {
+    std::istringstream in(args);
+    int size = 0;
+    std::string cells, remaining;
+    if (!(in >> size >> cells >> remaining)) return false;
+    if (size <= 0 || size > MAX_AI_BOARD_SIZE || cells.size() != size_t(size) * size) return false;
+
+    k.reset(size);
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            const uint64_t bit = uint64_t(1) << x;
+            switch (cells[y * size + x]) {
+            case 'o': k.miss[y] |= bit; break;
+            case 'x': k.hit[y] |= bit; break;
+            case '#': k.sunk[y] |= bit; break;
+            case '*': k.excluded[y] |= bit; break;
+            case '.': break;
+            default: return false;
+            }
+        }
+    }
+    return parseSizes(remaining, ',', k.remainingShips);
+}
+
+std::string placementReply(const Grid& grid) {
+    std::string line = "placement";
+    const int n = int(grid.size());
+    for (int y = 0; y < n; ++y) {
+        for (int x = 0; x < n; ++x) {
+            // Начало корабля: слева и сверху нет его клеток
+            if (!isShipCell(grid, x, y) || isShipCell(grid, x - 1, y) || isShipCell(grid, x, y - 1)) continue;
+            const bool horizontal = isShipCell(grid, x + 1, y);
+            int len = 1;
+            while (isShipCell(grid, x + (horizontal ? len : 0), y + (horizontal ? 0 : len))) ++len;
+            line += ' ' + std::to_string(x) + ',' + std::to_string(y) + ',' + std::to_string(len) + ',' +
+                    (horizontal ? 'h' : 'v');
+        }
+    }
+    return line;
+}
+
+bool applyPlacement(const std::string& args, const std::vector<int>& fleet, Grid& grid) {
+    struct Placed { int x, y, len; bool horizontal; };
+    std::vector<Placed> ships;
+    std::istringstream in(args);
+    std::string token;
+    while (in >> token) {
+        Placed p;
+        char orientation = 0;
+        if (std::sscanf(token.c_str(), "%d,%d,%d,%c", &p.x, &p.y, &p.len, &orientation) != 4) return false;
+        if (orientation != 'h' && orientation != 'v') return false;
+        p.horizontal = orientation == 'h';
+        ships.push_back(p);
+    }
+
+    std::vector<int> lengths, expected = fleet;
+    for (const Placed& p : ships) lengths.push_back(p.len);
+    std::sort(lengths.begin(), lengths.end());
+    std::sort(expected.begin(), expected.end());
+    if (lengths != expected) return false;
+
+    Grid placed = grid;
+    for (const Placed& p : ships) {
+        if (!rules::canPlace(placed, p.x, p.y, p.len, p.horizontal) ||
+            !rules::isSurroundingClear(placed, p.x, p.y, p.len, p.horizontal))
+            return false;
+        rules::placeShip(placed, p.x, p.y, p.len, p.horizontal);
+    }
+    grid = std::move(placed);
+    return true;
+}
+
+} // namespace botproto
@@ -0,0 +1,67 @@
+// botprotocol.h
+#ifndef BOTPROTOCOL_H
+#define BOTPROTOCOL_H
+
+#include "boardknowledge.h"
+#include "gamerules.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+// Протокол внешних ботов, по образцу UCI в шахматах: хост запускает бота дочерним
+// процессом и обменивается с ним строками через stdin/stdout. Язык бота любой.
+// Позиция каждый раз передаётся целиком, поэтому бот может не хранить состояние,
+// а хост - слать ему пачки посторонних позиций.
+//
+// Хост -> бот:
+//   sbp                          рукопожатие; бот отвечает "id name ..." (можно опустить) и "sbpok"
+//   newgame <size> <mines> <fleet>
+//                                новая партия: сторона поля, число мин, длины кораблей через ','
+//   isready                      бот отвечает "readyok", когда обработал всё присланное до этого
+//   place                        бот отвечает "placement x,y,длина,h|v ..." - корабль на каждую длину флота
+//   position <size> <cells> <remaining>
+//                                поле соперника: size*size символов по строкам, '.' - не открыто,
+//                                'o' - промах, 'x' - попадание, '#' - потопленный корабль,
+//                                '*' - клетка уже выбрана в этот залп (не стрелять, но корабль там может быть);
+//                                remaining - длины кораблей на плаву через ',' или '-'
+//   go movetime <ms>             бот отвечает "bestmove x y" за отведённое время
+//   batch <n> movetime <ms>      следом n строк position; бот отвечает n строк bestmove по порядку,
+//                                на всю пачку отводится n * ms
+//   result <x> <y> <M|H|X|R> <sunk>
+//                                исход выстрела бота: промах, попадание, мина, повтор; sunk - длины
+//                                потопленных им кораблей через '/' или '-'
+//   stop                         ответить на текущий go или batch немедленно
+//   quit
+// Бот -> хост: id, sbpok, readyok, placement, bestmove; строки info и прочие хост пропускает.
+//
+// Время хост отмеряет сам: не успел бот к сроку с запасом - хост шлёт stop, не ответил и на
+// него - ход берётся запасной, а поздние ответы отбрасываются синхронизацией через isready.
+namespace botproto {
+
+// Запас на передачу по каналу и планирование процесса сверх отведённого боту времени
+const int GRACE_MS = 50;
+// Сколько ждать ответа на рукопожатие, isready и place
+const int HANDSHAKE_TIMEOUT_MS = 5000;
+
+std::string newGameCommand(int size, int mines, const std::vector<int>& fleet);
+std::string positionCommand(const BoardKnowledge& knowledge);
+std::string goCommand(int moveTimeMs);
+std::string batchCommand(size_t count, int moveTimeMs);
+std::string resultCommand(int x, int y, const rules::ShotResult& result);
+
+// Первое слово строки и остаток после пробелов
+std::pair<std::string, std::string> splitCommand(const std::string& line);
+
+bool parseBestMove(const std::string& args, int& x, int& y);
+bool parseNewGame(const std::string& args, int& size, int& mines, std::vector<int>& fleet);
+bool parsePosition(const std::string& args, BoardKnowledge& knowledge);
+
+// Ответ бота на place по его полю (корабли - клетки Ship)
+std::string placementReply(const Grid& grid);
+// Расстановка бота ставится на поле хоста (там уже могут стоять мины), если она
+// соответствует флоту и правилам: без выхода за поле, наложений и касаний
+bool applyPlacement(const std::string& args, const std::vector<int>& fleet, Grid& grid);
+
+} // namespace botproto
+
+#endif // BOTPROTOCOL_H
@@ -0,0 +1,408 @@
+#include "endgamesolver.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <map>
+
+namespace {
+
+// Примерная стоимость одной записи unordered_map (узел, ключ, значение, корзина)
+const size_t TABLE_ENTRY_BYTES = 48;
+
+uint64_t mix(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+uint64_t maskHash(const CellMask& m, uint64_t salt) {
+    return mix(m.w[0] ^ mix(m.w[1] ^ mix(m.w[2] ^ salt)));
+}
+
+// Хеш расстановки не зависит от порядка кораблей - одинаковые корабли взаимозаменяемы
+uint64_t layoutHash(const std::vector<CellMask>& ships) {
+    uint64_t h = 0;
+    for (const auto& s : ships) h += maskHash(s, 0x51ED2701);
+    return h;
+}
+
+template <typename F>
+void forEachBit(const CellMask& m, F f) {
+    for (int i = 0; i < 3; ++i) {
+        uint64_t word = m.w[i];
+        while (word) {
+            f(i * 64 + __builtin_ctzll(word));
+            word &= word - 1;
+        }
+    }
+}
+
+CellMask transformMask(const CellMask& m, const std::vector<int>& perm) {
+    CellMask out;
+    forEachBit(m, [&](int c) { out.set(perm[c]); });
+    return out;
+}
+
+double binomial(int p, int k) {
+    double r = 1;
+    for (int i = 0; i < k; ++i) r *= double(p - i) / (i + 1);
+    return std::max(r, 0.0);
+}
+
+// Начала положений длины len, накрывающих клетку c своей линии: c - len + 1 .. c
+uint64_t startsAround(int c, int len) {
+    const uint64_t window = (uint64_t(1) << len) - 1;
+    return c >= len - 1 ? window << (c - len + 1) : window >> (len - 1 - c);
+}
+
+// Верхняя оценка числа расстановок без перебора, по битовым строкам свободных клеток.
+// Корабли считаются независимыми, поэтому расстановок не больше произведения C(p, k)
+// по размерам: p - положений размера на свободных клетках, k - кораблей этого размера.
+// Открытое попадание накрывает хотя бы один корабль: для первого из них произведение
+// заменяется суммой по положениям, которые его накрывают
+double layoutUpperBound(const BoardKnowledge& knowledge) {
+    const int n = knowledge.size;
+    const uint64_t full = n >= 64 ? ~uint64_t(0) : (uint64_t(1) << n) - 1;
+    std::vector<uint64_t> freeRows(n), freeCols(n, 0);
+    int hx = -1, hy = -1;
+    for (int y = 0; y < n; ++y) {
+        freeRows[y] = ~(knowledge.miss[y] | knowledge.sunk[y]) & full;
+        for (int x = 0; x < n; ++x) {
+            if ((freeRows[y] >> x) & 1) freeCols[x] |= uint64_t(1) << y;
+        }
+        if (hx < 0 && knowledge.hit[y]) {
+            hx = __builtin_ctzll(knowledge.hit[y]);
+            hy = y;
+        }
+    }
+
+    std::map<int, int> ships;
+    for (int len : knowledge.remainingShips) ships[len]++;
+
+    // Положения каждого размера и те из них, что накрывают попадание (hx, hy)
+    std::map<int, int> total, covering;
+    for (const auto& entry : ships) {
+        const int len = entry.first;
+        for (int line = 0; line < n; ++line) {
+            uint64_t across = freeRows[line], down = freeCols[line];
+            for (int i = 1; i < len; ++i) {
+                across &= freeRows[line] >> i;
+                down &= freeCols[line] >> i;
+            }
+            if (len == 1) down = 0;     // одноклеточный корабль не имеет ориентации
+            total[len] += __builtin_popcountll(across) + __builtin_popcountll(down);
+            if (hx < 0) continue;
+            if (line == hy) covering[len] += __builtin_popcountll(across & startsAround(hx, len));
+            if (line == hx) covering[len] += __builtin_popcountll(down & startsAround(hy, len));
+        }
+    }
+
+    auto product = [&](int except) {
+        double r = 1;
+        for (const auto& [len, count] : ships) r *= binomial(total[len], count - (len == except));
+        return r;
+    };
+    if (hx < 0) return product(0);
+    double bound = 0;
+    for (const auto& entry : ships) bound += covering[entry.first] * product(entry.first);
+    return bound;
+}
+
+} // namespace
+
+int CellMask::count() const {
+    return __builtin_popcountll(w[0]) + __builtin_popcountll(w[1]) + __builtin_popcountll(w[2]);
+}
+
+EndgameSolver::EndgameSolver(const EndgameConfig& config) : config(config) {}
+
+bool EndgameSolver::enumerateLayouts(const BoardKnowledge& knowledge) {
+    layouts.clear();
+
+    CellMask free, hits;
+    for (int y = 0; y < n; ++y) {
+        for (int x = 0; x < n; ++x) {
+            bool blocked = ((knowledge.miss[y] | knowledge.sunk[y]) >> x) & 1;
+            if (!blocked) free.set(y * n + x);
+            if ((knowledge.hit[y] >> x) & 1) hits.set(y * n + x);
+        }
+    }
+
+    std::vector<int> ships = knowledge.remainingShips;
+    std::sort(ships.begin(), ships.end(), std::greater<int>());
+
+    // Все положения каждого размера на свободных клетках. Корабль целиком из
+    // попаданий уже был бы потоплен, поэтому такие положения отбрасываются.
+    std::map<int, std::vector<CellMask>> placements;
+    for (int len : ships) {
+        if (placements.count(len)) continue;
+        auto& list = placements[len];
+        for (int y = 0; y < n; ++y) {
+            for (int x = 0; x < n; ++x) {
+                for (int h = 0; h < (len > 1 ? 2 : 1); ++h) {
+                    CellMask m;
+                    bool ok = true;
+                    for (int i = 0; i < len && ok; ++i) {
+                        int px = x + (h ? 0 : i);
+                        int py = y + (h ? i : 0);
+                        ok = px < n && py < n && free.test(py * n + px);
+                        if (ok) m.set(py * n + px);
+                    }
+                    if (ok && (m & ~hits).any()) list.push_back(m);
+                }
+            }
+        }
+    }
+
+    // Суммарная длина кораблей начиная с i - для отсечения, если попадания не накрыть
+    std::vector<int> capacity(ships.size() + 1, 0);
+    for (int i = int(ships.size()) - 1; i >= 0; --i)
+        capacity[i] = capacity[i + 1] + ships[i];
+
+    std::vector<CellMask> chosen(ships.size());
+    size_t budget = config.nodeLimit;
+    bool overflow = false;
+
+    // Одинаковые корабли перебираются только в порядке возрастания индекса положения,
+    // так что перестановки одной расстановки не дублируются
+    auto place = [&](auto& self, size_t i, size_t from, const CellMask& occupied) -> void {
+        if (overflow) return;
+        if (budget-- == 0 || layouts.size() >= config.layoutThreshold) {
+            overflow = true;
+            return;
+        }
+        CellMask uncovered = hits & ~occupied;
+        if (i == ships.size()) {
+            if (!uncovered.any())
+                layouts.push_back({chosen, occupied, layoutHash(chosen)});
+            return;
+        }
+        if (uncovered.count() > capacity[i]) return;
+
+        const auto& list = placements[ships[i]];
+        size_t start = (i > 0 && ships[i] == ships[i - 1]) ? from : 0;
+        for (size_t j = start; j < list.size() && !overflow; ++j) {
+            if ((list[j] & occupied).any()) continue;
+            chosen[i] = list[j];
+            self(self, i + 1, j + 1, occupied | list[j]);
+        }
+    };
+    place(place, 0, 0, CellMask());
+
+    return !overflow && layouts.size() < config.layoutThreshold;
+}
+
+void EndgameSolver::buildSymmetries(const BoardKnowledge& knowledge) {
+    symCell.clear();
+    symLayout.clear();
+
+    std::unordered_map<uint64_t, int> index;
+    for (size_t i = 0; i < layouts.size(); ++i) index[layouts[i].hash] = int(i);
+
+    // Семь нетривиальных симметрий квадрата: отражения и повороты
+    for (int g = 1; g < 8; ++g) {
+        std::vector<int> perm(cells);
+        for (int y = 0; y < n; ++y) {
+            for (int x = 0; x < n; ++x) {
+                int tx = (g & 1) ? n - 1 - x : x;
+                int ty = (g & 2) ? n - 1 - y : y;
+                if (g & 4) std::swap(tx, ty);
+                perm[y * n + x] = ty * n + tx;
+            }
+        }
+
+        // Симметрия годится, только если не меняет исходное знание
+        bool invariant = true;
+        for (int y = 0; y < n && invariant; ++y) {
+            for (int x = 0; x < n && invariant; ++x) {
+                int t = perm[y * n + x];
+                int tx = t % n, ty = t / n;
+                invariant = ((knowledge.miss[y] >> x) & 1) == ((knowledge.miss[ty] >> tx) & 1) &&
+                            ((knowledge.hit[y] >> x) & 1) == ((knowledge.hit[ty] >> tx) & 1) &&
+                            ((knowledge.sunk[y] >> x) & 1) == ((knowledge.sunk[ty] >> tx) & 1);
+            }
+        }
+        if (!invariant) continue;
+
+        std::vector<int> image(layouts.size());
+        for (size_t i = 0; i < layouts.size() && invariant; ++i) {
+            std::vector<CellMask> ships;
+            for (const auto& s : layouts[i].ships) ships.push_back(transformMask(s, perm));
+            auto it = index.find(layoutHash(ships));
+            invariant = it != index.end();
+            if (invariant) image[i] = it->second;
+        }
+        if (!invariant) continue;
+
+        symCell.push_back(std::move(perm));
+        symLayout.push_back(std::move(image));
+    }
+}
+
+double EndgameSolver::search(const std::vector<int>& set, uint64_t setHash, const CellMask& shot,
+                             int cellsLeft, int *bestCell) {
+    *bestCell = -1;
+    if (cellsLeft == 0) return 0.0;
+    if (++nodes > config.nodeLimit) {
+        aborted = true;
+        return cellsLeft;
+    }
+    if ((nodes & 1023) == 0) {
+        if ((stopFlag && stopFlag->load(std::memory_order_relaxed)) ||
+            (config.timeBudgetMs > 0 && std::chrono::steady_clock::now() >= deadline)) {
+            aborted = true;
+            return cellsLeft;
+        }
+    }
+
+    const uint64_t key = setHash ^ maskHash(shot, 0x7A3C5E11);
+    auto found = table.find(key);
+    if (found != table.end()) {
+        *bestCell = found->second.cell;
+        return found->second.value;
+    }
+
+    // Сколько расстановок накрывают каждую нестрелянную клетку
+    int cover[MAX_SOLVER_BOARD_SIZE * MAX_SOLVER_BOARD_SIZE] = {};
+    for (int li : set) forEachBit(layouts[li].occupied & ~shot, [&](int c) { cover[c]++; });
+
+    std::vector<int> candidates;
+    for (int c = 0; c < cells; ++c) {
+        if (cover[c] == int(set.size())) {
+            // Гарантированное попадание всё равно придётся сделать, и раньше - не хуже
+            candidates.assign(1, c);
+            break;
+        }
+        if (cover[c] > 0) candidates.push_back(c);
+    }
+
+    if (candidates.size() > 1) {
+        // Симметрии, под которыми текущее состояние переходит само в себя
+        std::vector<size_t> active;
+        for (size_t g = 0; g < symCell.size(); ++g) {
+            if (!(transformMask(shot, symCell[g]) == shot)) continue;
+            uint64_t h = 0;
+            for (int li : set) h += layouts[symLayout[g][li]].hash;
+            if (h == setHash) active.push_back(g);
+        }
+        // Из каждой орбиты клеток оставляем только наименьшую
+        if (!active.empty()) {
+            candidates.erase(std::remove_if(candidates.begin(), candidates.end(), [&](int c) {
+                for (size_t g : active)
+                    if (symCell[g][c] < c) return true;
+                return false;
+            }), candidates.end());
+        }
+        std::stable_sort(candidates.begin(), candidates.end(),
+                         [&](int a, int b) { return cover[a] > cover[b]; });
+    }
+
+    const double total = double(set.size());
+    double best = std::numeric_limits<double>::infinity();
+    int bestC = -1;
+
+    // Разбиение по ответу: 0 - промах, 1 - попадание, 1 + s - потоплен корабль длины s
+    const int codes = MAX_SOLVER_BOARD_SIZE + 2;
+    std::vector<int> outcome[codes];
+    uint64_t outcomeHash[codes];
+
+    for (int c : candidates) {
+        for (int code = 0; code < codes; ++code) {
+            outcome[code].clear();
+            outcomeHash[code] = 0;
+        }
+        for (int li : set) {
+            int code = 0;
+            for (const auto& ship : layouts[li].ships) {
+                if (!ship.test(c)) continue;
+                CellMask rest = ship & ~shot;
+                code = rest.count() == 1 ? 1 + ship.count() : 1;
+                break;
+            }
+            outcome[code].push_back(li);
+            outcomeHash[code] += layouts[li].hash;
+        }
+
+        // Нижняя оценка: каждый следующий выстрел - попадание
+        double value = 1.0;
+        for (int code = 0; code < codes; ++code)
+            value += outcome[code].size() / total * (cellsLeft - (code != 0));
+        if (value >= best) continue;
+
+        CellMask next = shot;
+        next.set(c);
+        for (int code = 0; code < codes; ++code) {
+            if (outcome[code].empty()) continue;
+            int childLeft = cellsLeft - (code != 0);
+            int childBest;
+            double v = search(outcome[code], outcomeHash[code], next, childLeft, &childBest);
+            value += outcome[code].size() / total * (v - childLeft);
+            if (value >= best || aborted) break;
+        }
+        if (aborted) return cellsLeft;
+
+        if (value < best) {
+            best = value;
+            bestC = c;
+            if (best <= cellsLeft) break; // лучше, чем все выстрелы в цель, не бывает
+        }
+    }
+
+    *bestCell = bestC;
+    if (table.size() * TABLE_ENTRY_BYTES >= config.tableBytes) table.clear();
+    table[key] = {float(best), int16_t(bestC)};
+    return best;
+}
+
+bool EndgameSolver::solve(const BoardKnowledge& knowledge, std::pair<int, int>& shot,
+                          double *expectedShots) {
+    n = knowledge.size;
+    cells = n * n;
+    if (n <= 0 || n > MAX_SOLVER_BOARD_SIZE || knowledge.remainingShips.empty()) return false;
+
+    // Перебор считает выстрелы по одному и не знает про клетки, уже выбранные
+    // в текущий залп; остальные клетки залпа добирает тепловая карта
+    if (std::any_of(knowledge.excluded.begin(), knowledge.excluded.end(), [](uint64_t r) { return r != 0; }))
+        return false;
+
+    // Остались одноклеточные корабли: все нестрелянные клетки для них равноценны,
+    // любой порядок выстрелов одинаково хорош, а перебор порядков растёт экспоненциально
+    if (std::all_of(knowledge.remainingShips.begin(), knowledge.remainingShips.end(),
+                    [](int len) { return len == 1; }))
+        return false;
+    // Дешёвая проверка до перебора: по оценке сверху расстановок может оказаться меньше порога
+    if (layoutUpperBound(knowledge) >= double(config.layoutThreshold)) return false;
+
+    if (!enumerateLayouts(knowledge) || layouts.empty()) return false;
+    buildSymmetries(knowledge);
+
+    std::vector<int> set(layouts.size());
+    uint64_t setHash = 0;
+    for (size_t i = 0; i < layouts.size(); ++i) {
+        set[i] = int(i);
+        setHash += layouts[i].hash;
+    }
+
+    CellMask known;
+    int openHits = 0;
+    for (int y = 0; y < n; ++y) {
+        for (int x = 0; x < n; ++x) {
+            if (knowledge.isKnown(x, y)) known.set(y * n + x);
+            if ((knowledge.hit[y] >> x) & 1) openHits++;
+        }
+    }
+    int cellsLeft = -openHits;
+    for (int len : knowledge.remainingShips) cellsLeft += len;
+
+    nodes = 0;
+    aborted = false;
+    deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(config.timeBudgetMs);
+    int best;
+    double value = search(set, setHash, known, cellsLeft, &best);
+    if (aborted || best < 0) return false;
+
+    shot = {best % n, best / n};
+    if (expectedShots) *expectedShots = value;
+    return true;
+}
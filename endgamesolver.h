@@ -0,0 +1,88 @@
+// endgamesolver.h
+#ifndef ENDGAMESOLVER_H
+#define ENDGAMESOLVER_H
+
+#include "boardknowledge.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Точный решатель эндшпиля работает на полях до 13x13 (169 клеток в трёх словах)
+const int MAX_SOLVER_BOARD_SIZE = 13;
+
+struct EndgameConfig {
+    size_t layoutThreshold = 200;       // решатель включается, когда расстановок меньше
+    size_t tableBytes = 64u << 20;      // потолок памяти таблицы транспозиций
+    size_t nodeLimit = 200000;          // ограничение перебора на один ход
+    int timeBudgetMs = 0;               // ограничение времени на ход; 0 - без ограничения
+};
+
+struct CellMask {
+    std::array<uint64_t, 3> w{};
+
+    void set(int i) { w[i >> 6] |= uint64_t(1) << (i & 63); }
+    bool test(int i) const { return (w[i >> 6] >> (i & 63)) & 1; }
+    bool any() const { return w[0] | w[1] | w[2]; }
+    int count() const;
+    bool operator==(const CellMask& o) const { return w == o.w; }
+    CellMask operator&(const CellMask& o) const { return {{w[0] & o.w[0], w[1] & o.w[1], w[2] & o.w[2]}}; }
+    CellMask operator|(const CellMask& o) const { return {{w[0] | o.w[0], w[1] | o.w[1], w[2] | o.w[2]}}; }
+    CellMask operator~() const { return {{~w[0], ~w[1], ~w[2]}}; }
+};
+
+class EndgameSolver {
+public:
+    explicit EndgameSolver(const EndgameConfig& config = EndgameConfig());
+
+    // Возвращает true, если расстановок меньше порога и перебор уложился в лимит.
+    // Тогда shot - клетка с минимальным ожидаемым числом оставшихся выстрелов.
+    // Перебор расстановок начинается, только если их оценка сверху меньше порога.
+    // С клетками, исключёнными из выбора (залп), решатель не работает.
+    bool solve(const BoardKnowledge& knowledge, std::pair<int, int>& shot,
+               double *expectedShots = nullptr);
+
+    void setConfig(const EndgameConfig& c) { config = c; }
+    const EndgameConfig& currentConfig() const { return config; }
+    size_t lastLayoutCount() const { return layouts.size(); }
+    size_t tableSize() const { return table.size(); }
+    void clearTable() { table.clear(); }
+    // Флаг отмены из другого потока: перебор прерывается, solve() возвращает false
+    void setStopFlag(const std::atomic<bool> *flag) { stopFlag = flag; }
+
+private:
+    struct Layout {
+        std::vector<CellMask> ships;
+        CellMask occupied;
+        uint64_t hash;
+    };
+    struct Entry {
+        float value;
+        int16_t cell;
+    };
+
+    EndgameConfig config;
+    int n = 0;
+    int cells = 0;
+    std::vector<Layout> layouts;
+    std::unordered_map<uint64_t, Entry> table;
+    size_t nodes = 0;
+    bool aborted = false;
+    const std::atomic<bool> *stopFlag = nullptr;
+    std::chrono::steady_clock::time_point deadline;
+
+    // Симметрии квадрата, сохраняющие исходное знание, и образы расстановок под ними
+    std::vector<std::vector<int>> symCell;
+    std::vector<std::vector<int>> symLayout;
+
+    bool enumerateLayouts(const BoardKnowledge& knowledge);
+    void buildSymmetries(const BoardKnowledge& knowledge);
+    double search(const std::vector<int>& set, uint64_t setHash, const CellMask& shot,
+                  int cellsLeft, int *bestCell);
+};
+
+#endif // ENDGAMESOLVER_H
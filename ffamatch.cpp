@@ -0,0 +1,164 @@
+#include "ffamatch.h"
+#include <algorithm>
+
+FfaMatch::FfaMatch(int gridSize, bool mines, int minesCount)
+    : size(gridSize), mines(mines), minesCount(minesCount) {}
+
+int FfaMatch::addPlayer(const std::string& name) {
+    Player p;
+    p.name = name;
+    p.board.assign(size, std::vector<Cell>(size, Empty));
+    players.push_back(std::move(p));
+    return int(players.size()) - 1;
+}
+
+bool FfaMatch::setFleet(int id, const Grid& board, std::mt19937& rng) {
+    if (id < 0 || id >= playerCount() || started() || int(board.size()) != size) return false;
+    for (const auto& column : board)
+        if (int(column.size()) != size) return false;
+
+    // Корабли - прямые отрезки, начинающиеся там, где слева и сверху нет палубы
+    struct Placed { int x, y, len; bool horizontal; };
+    std::vector<Placed> ships;
+    auto isShip = [&](int x, int y) { return rules::isInside(board, x, y) && board[x][y] == Ship; };
+    for (int x = 0; x < size; ++x) {
+        for (int y = 0; y < size; ++y) {
+            if (!isShip(x, y) || isShip(x - 1, y) || isShip(x, y - 1)) continue;
+            int across = 1, down = 1;
+            while (isShip(x + across, y)) ++across;
+            while (isShip(x, y + down)) ++down;
+            if (across > 1 && down > 1) return false;
+            ships.push_back({x, y, std::max(across, down), across > 1});
+        }
+    }
+
+    std::vector<int> sizes = rules::shipSizes(rules::fleetFor(size));
+    std::vector<int> lengths;
+    for (const Placed& p : ships) lengths.push_back(p.len);
+    std::sort(lengths.begin(), lengths.end());
+    std::sort(sizes.begin(), sizes.end());
+    if (lengths != sizes) return false;
+
+    // Та же проверка, что у ручной расстановки: без наложений и касаний
+    Grid clean(size, std::vector<Cell>(size, Empty));
+    for (const Placed& p : ships) {
+        if (!rules::canPlace(clean, p.x, p.y, p.len, p.horizontal) ||
+            !rules::isSurroundingClear(clean, p.x, p.y, p.len, p.horizontal))
+            return false;
+        rules::placeShip(clean, p.x, p.y, p.len, p.horizontal);
+    }
+    // Отростки сбоку от отрезка в него не попали - такое поле не флот
+    for (int x = 0; x < size; ++x)
+        for (int y = 0; y < size; ++y)
+            if ((board[x][y] == Ship) != (clean[x][y] == Ship)) return false;
+    if (mines) rules::placeMines(clean, minesCount, rng);
+
+    Player& p = players[id];
+    p.board = std::move(clean);
+    p.remaining.assign(size + 1, 0);
+    for (int len : sizes) p.remaining[len]++;
+    p.shipsLeft = int(sizes.size());
+    p.ready = true;
+    return true;
+}
+
+bool FfaMatch::allReady() const {
+    return std::all_of(players.begin(), players.end(), [](const Player& p) { return p.ready || !p.alive; });
+}
+
+void FfaMatch::start(int firstPlayer) {
+    isStarted = true;
+    currentTurn = players[firstPlayer].alive ? firstPlayer : nextAlive(firstPlayer);
+}
+
+int FfaMatch::alivePlayers() const {
+    return int(std::count_if(players.begin(), players.end(), [](const Player& p) { return p.alive; }));
+}
+
+int FfaMatch::nextAlive(int from) const {
+    const int n = playerCount();
+    for (int i = 1; i <= n; ++i) {
+        int id = (from + i) % n;
+        if (players[id].alive) return id;
+    }
+    return -1;
+}
+
+void FfaMatch::checkWinner(int candidate) {
+    if (alivePlayers() != 1) return;
+    winnerId = players[candidate].alive ? candidate : nextAlive(candidate);
+    currentTurn = -1;
+}
+
+FfaMatch::ShotOutcome FfaMatch::shoot(int shooter, int target, int x, int y) {
+    ShotOutcome out;
+    out.nextTurn = currentTurn;
+    if (!started() || finished() || shooter != currentTurn || target == shooter ||
+        target < 0 || target >= playerCount() || !players[target].alive)
+        return out;
+
+    Player& t = players[target];
+    if (!rules::isInside(t.board, x, y) || t.board[x][y] == Hit || t.board[x][y] == Miss) return out;
+
+    out.accepted = true;
+    out.result = rules::resolveShot(t.board, x, y);
+    for (const auto& cells : out.result.sunkShips) {
+        int len = int(cells.size());
+        if (len > size || t.remaining[len] == 0) continue;
+        t.remaining[len]--;
+        t.shipsLeft--;
+    }
+
+    // Подстраховка: поле без палуб выбывает, даже если счёт кораблей разошёлся
+    bool afloat = false;
+    for (const auto& column : t.board)
+        afloat = afloat || std::find(column.begin(), column.end(), Ship) != column.end();
+    if (!afloat) t.shipsLeft = 0;
+
+    if (t.shipsLeft == 0) {
+        t.alive = false;
+        out.eliminated = true;
+        checkWinner(shooter);
+    }
+    if (!finished() && out.result.kind != rules::ShotResult::Hit) currentTurn = nextAlive(shooter);
+    out.nextTurn = currentTurn;
+    out.winner = winnerId;
+    return out;
+}
+
+FfaMatch::ShotOutcome FfaMatch::removePlayer(int id) {
+    ShotOutcome out;
+    if (id < 0 || id >= playerCount() || !players[id].alive) {
+        out.nextTurn = currentTurn;
+        return out;
+    }
+    players[id].alive = false;
+    out.eliminated = true;
+    if (started() && !finished()) {
+        checkWinner(id);
+        if (!finished() && currentTurn == id) currentTurn = nextAlive(id);
+    }
+    out.nextTurn = currentTurn;
+    out.winner = winnerId;
+    return out;
+}
+
+std::string FfaMatch::encodeShot(int shooter, int target, int x, int y, const rules::ShotResult& result) {
+    const char kind = result.kind == rules::ShotResult::Miss ? 'M' : result.kind == rules::ShotResult::Hit ? 'H'
+                    : result.kind == rules::ShotResult::MineHit ? 'X' : 'R';
+    // Маска взрыва мины: бит соседа (dx, dy), центр пропущен
+    int mask = 0;
+    if (result.kind == rules::ShotResult::MineHit) {
+        for (auto [cx, cy] : result.shipCellsHit) {
+            int bit = (cx - x + 1) * 3 + (cy - y + 1);
+            mask |= 1 << (bit > 4 ? bit - 1 : bit);
+        }
+    }
+    std::string line = std::to_string(shooter) + ',' + std::to_string(target) + ',' + std::to_string(x) + ',' +
+                       std::to_string(y) + ',' + kind + ',' + std::to_string(mask) + ',';
+    for (size_t i = 0; i < result.sunkShips.size(); ++i) {
+        if (i) line += '/';
+        line += std::to_string(result.sunkShips[i].size());
+    }
+    return line;
+}
@@ -0,0 +1,77 @@
+// ffamatch.h
+#ifndef FFAMATCH_H
+#define FFAMATCH_H
+
+#include "gamerules.h"
+#include <random>
+#include <string>
+#include <vector>
+
+const int FFA_MIN_PLAYERS = 4;
+const int FFA_MAX_PLAYERS = 16;
+
+// Партия "все против всех" без Qt: её ведёт сервер, клиенты только шлют выстрелы.
+// Поля всех игроков хранятся здесь, каждый выстрел разбирается rules::resolveShot.
+// Ход идёт по кругу среди оставшихся; попадание оставляет ход у стрелявшего,
+// промах и мина передают его следующему. Игрок без кораблей выбывает.
+class FfaMatch {
+public:
+    struct Player {
+        std::string name;
+        Grid board;
+        std::vector<int> remaining;     // кораблей каждой длины на плаву
+        int shipsLeft = 0;
+        bool ready = false;
+        bool alive = true;
+    };
+
+    struct ShotOutcome {
+        bool accepted = false;
+        rules::ShotResult result;
+        bool eliminated = false;        // цель выбыла этим выстрелом
+        int nextTurn = -1;
+        int winner = -1;
+    };
+
+    FfaMatch(int gridSize, bool mines, int minesCount = 2);
+
+    int gridSize() const { return size; }
+    bool minesEnabled() const { return mines; }
+    int playerCount() const { return int(players.size()); }
+    const Player& player(int id) const { return players[id]; }
+
+    int addPlayer(const std::string& name);
+    // Поле игрока: только корабли, ровно флот fleetFor(size) без наложений и касаний.
+    // Мины сервер ставит сам, чтобы игрок не знал их и не мог подложить
+    bool setFleet(int id, const Grid& board, std::mt19937& rng);
+    bool allReady() const;
+
+    void start(int firstPlayer);
+    bool started() const { return isStarted; }
+    bool finished() const { return winnerId >= 0; }
+    int turn() const { return currentTurn; }
+    int winner() const { return winnerId; }
+    int alivePlayers() const;
+
+    ShotOutcome shoot(int shooter, int target, int x, int y);
+    // Игрок ушёл: выбывает; если ходил он, ход переходит дальше
+    ShotOutcome removePlayer(int id);
+
+    // Строка события для всех участников: "shooter,target,x,y,исход,маска,длины" -
+    // те же поля, что у записи SALVO_RESULT, плюс кто и в кого стрелял
+    static std::string encodeShot(int shooter, int target, int x, int y, const rules::ShotResult& result);
+
+private:
+    int size;
+    bool mines;
+    int minesCount;
+    std::vector<Player> players;
+    bool isStarted = false;
+    int currentTurn = -1;
+    int winnerId = -1;
+
+    int nextAlive(int from) const;
+    void checkWinner(int candidate);
+};
+
+#endif // FFAMATCH_H
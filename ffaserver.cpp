@@ -0,0 +1,138 @@
+#include "ffaserver.h"
+#include <QDebug>
+#include <QStringList>
+
+FfaServer::FfaServer(int gridSize, bool mines, int minesCount, int players, QObject *parent)
+    : QObject(parent), match(gridSize, mines, minesCount), expectedPlayers(players),
+      rng(std::random_device{}())
+{
+    connect(&server, &QTcpServer::newConnection, this, &FfaServer::newConnection);
+}
+
+bool FfaServer::listen(quint16 port) {
+    return server.listen(QHostAddress::Any, port);
+}
+
+void FfaServer::newConnection() {
+    while (server.hasPendingConnections()) {
+        QTcpSocket *socket = server.nextPendingConnection();
+        connect(socket, &QTcpSocket::readyRead, this, &FfaServer::readData);
+        connect(socket, &QTcpSocket::disconnected, this, &FfaServer::disconnected);
+    }
+}
+
+void FfaServer::readData() {
+    QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
+    while (socket && socket->canReadLine()) {
+        QString message = QString::fromUtf8(socket->readLine()).trimmed();
+        int colon = message.indexOf(':');
+        if (colon > 0) processCommand(socket, message.left(colon), message.mid(colon + 1));
+    }
+}
+
+void FfaServer::disconnected() {
+    QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
+    if (!socket) return;
+    const int id = playerId(socket);
+    socket->deleteLater();
+    if (id < 0) return;
+
+    sockets[id] = nullptr;
+    FfaMatch::ShotOutcome outcome = match.removePlayer(id);
+    if (!outcome.eliminated) return;
+    QByteArray lines = "OUT:" + QByteArray::number(id) + "\n";
+    appendOutcome(lines, id, outcome);
+    broadcast(lines);
+    maybeStart();
+}
+
+int FfaServer::playerId(QTcpSocket *socket) const {
+    for (size_t i = 0; i < sockets.size(); ++i)
+        if (sockets[i] == socket) return int(i);
+    return -1;
+}
+
+void FfaServer::broadcast(const QByteArray& lines) {
+    // Буфер общий: QByteArray не копируется, каждый сокет лишь дописывает его в свою очередь
+    for (QTcpSocket *socket : sockets) {
+        if (socket && socket->state() == QAbstractSocket::ConnectedState) socket->write(lines);
+    }
+}
+
+QByteArray FfaServer::playersLine() const {
+    QStringList entries;
+    for (int id = 0; id < match.playerCount(); ++id)
+        entries << QString::number(id) + "=" + QString::fromStdString(match.player(id).name);
+    return "PLAYERS:" + entries.join(';').toUtf8() + "\n";
+}
+
+void FfaServer::appendOutcome(QByteArray& lines, int player, const FfaMatch::ShotOutcome& outcome) const {
+    if (outcome.winner >= 0) lines += "WINNER:" + QByteArray::number(outcome.winner) + "\n";
+    else if (match.started() && outcome.nextTurn >= 0 && (outcome.nextTurn != player || outcome.accepted))
+        lines += "TURN:" + QByteArray::number(outcome.nextTurn) + "\n";
+}
+
+void FfaServer::maybeStart() {
+    if (match.started() || match.playerCount() < expectedPlayers || !match.allReady() || match.alivePlayers() < 2)
+        return;
+    std::uniform_int_distribution<int> first(0, match.playerCount() - 1);
+    match.start(first(rng));
+    broadcast("START:\nTURN:" + QByteArray::number(match.turn()) + "\n");
+}
+
+void FfaServer::processCommand(QTcpSocket *socket, const QString& command, const QString& data) {
+    const int id = playerId(socket);
+
+    if (command == "JOIN") {
+        if (id >= 0) return;
+        if (match.playerCount() >= expectedPlayers || match.started()) {
+            socket->write("FULL:\n");
+            socket->disconnectFromHost();
+            return;
+        }
+        QString name = data.left(24).trimmed();
+        name.remove(';').remove('=');
+        if (name.isEmpty()) name = "Игрок";
+        int newId = match.addPlayer(name.toStdString());
+        sockets.push_back(socket);
+        socket->write("WELCOME:" + QByteArray::number(newId) + "," + QByteArray::number(match.gridSize()) + "," +
+                      QByteArray::number(match.minesEnabled() ? 1 : 0) + "," +
+                      QByteArray::number(expectedPlayers) + "\n");
+        // Новичку - кто уже готов; всем - новый список игроков
+        for (int other = 0; other < newId; ++other) {
+            if (match.player(other).ready) socket->write("READY:" + QByteArray::number(other) + "\n");
+        }
+        broadcast(playersLine());
+        qDebug() << "FFA player joined:" << newId << name;
+    }
+    else if (command == "FLEET" && id >= 0) {
+        const int n = match.gridSize();
+        if (data.size() != n * n) return;
+        Grid board(n, std::vector<Cell>(n, Empty));
+        for (int y = 0; y < n; ++y)
+            for (int x = 0; x < n; ++x)
+                if (data[y * n + x] == QLatin1Char('S')) board[x][y] = Ship;
+        if (!match.setFleet(id, board, rng)) {
+            qDebug() << "FFA fleet rejected for player" << id;
+            return;
+        }
+        broadcast("READY:" + QByteArray::number(id) + "\n");
+        maybeStart();
+    }
+    else if (command == "SHOT" && id >= 0) {
+        QStringList parts = data.split(',');
+        if (parts.size() != 3) return;
+        const int target = parts[0].toInt();
+        const int x = parts[1].toInt();
+        const int y = parts[2].toInt();
+
+        FfaMatch::ShotOutcome outcome = match.shoot(id, target, x, y);
+        if (!outcome.accepted) return;
+
+        // Событие, выбывание и следующий ход - одним буфером на всех
+        QByteArray lines = "SHOT:" + QByteArray::fromStdString(FfaMatch::encodeShot(id, target, x, y, outcome.result)) + "\n";
+        if (outcome.eliminated) lines += "OUT:" + QByteArray::number(target) + "\n";
+        appendOutcome(lines, id, outcome);
+        broadcast(lines);
+    }
+}
@@ -0,0 +1,52 @@
+// ffaserver.h
+#ifndef FFASERVER_H
+#define FFASERVER_H
+
+#include "ffamatch.h"
+#include <QByteArray>
+#include <QObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <random>
+#include <vector>
+
+const quint16 FFA_PORT = 12346;
+
+// Сервер партии "все против всех". Строки протокола те же "КОМАНДА:данные\n", что и в игре вдвоём.
+// Клиент -> сервер:
+//   JOIN:имя, FLEET:поле (size * size символов по строкам, 'S' - корабль, '.' - пусто),
+//   SHOT:цель,x,y
+// Сервер -> клиенты:
+//   WELCOME:id,size,мины,игроков; PLAYERS:id=имя;...; READY:id; START:;
+//   TURN:id; SHOT:стрелявший,цель,x,y,исход,маска,длины; OUT:id; WINNER:id; FULL:
+// Каждое событие кодируется один раз и одним буфером пишется во все сокеты:
+// стоимость рассылки линейна по числу игроков.
+class FfaServer : public QObject {
+    Q_OBJECT
+public:
+    FfaServer(int gridSize, bool mines, int minesCount, int players, QObject *parent = nullptr);
+
+    bool listen(quint16 port = FFA_PORT);
+    QString errorString() const { return server.errorString(); }
+
+private slots:
+    void newConnection();
+    void readData();
+    void disconnected();
+
+private:
+    QTcpServer server;
+    FfaMatch match;
+    int expectedPlayers;
+    std::vector<QTcpSocket *> sockets;      // по id игрока; nullptr - ушёл
+    std::mt19937 rng;
+
+    void processCommand(QTcpSocket *socket, const QString& command, const QString& data);
+    void broadcast(const QByteArray& lines);
+    QByteArray playersLine() const;
+    int playerId(QTcpSocket *socket) const;
+    void maybeStart();
+    void appendOutcome(QByteArray& lines, int player, const FfaMatch::ShotOutcome& outcome) const;
+};
+
+#endif // FFASERVER_H
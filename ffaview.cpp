@@ -0,0 +1,318 @@
+#include "ffaview.h"
+#include "battleshipgame.h"
+#include "gamerules.h"
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QStringList>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+QBrush cellBrush(Cell state, bool sunk) {
+    switch (state) {
+    case Ship: return QBrush(COLOR_SHIP);
+    case Hit: return QBrush(sunk ? QColor(110, 30, 30) : COLOR_HIT);
+    case Miss: return QBrush(COLOR_MISS);
+    case Mine: return QBrush(COLOR_MINE);
+    default: return QBrush(QColor(10, 30, 80));
+    }
+}
+
+// Бит соседней клетки (dx, dy) в маске взрыва мины - как в SALVO_RESULT
+int neighbourBit(int dx, int dy) {
+    int bit = (dx + 1) * 3 + (dy + 1);
+    return bit > 4 ? bit - 1 : bit;
+}
+
+const int MARGIN = 40;
+const int TITLE_HEIGHT = 30;
+}
+
+FfaView::FfaView(const QString& host, quint16 port, const QString& name, QWidget *parent)
+    : QGraphicsView(parent), playerName(name), rng(std::random_device{}())
+{
+    scene = new QGraphicsScene(this);
+    setScene(scene);
+    setBackgroundBrush(QBrush(COLOR_BACKGROUND));
+    setWindowTitle("Морской бой: все против всех");
+    setFocusPolicy(Qt::StrongFocus);
+
+    messageItem = scene->addText(QString());
+    messageItem->setFont(QFont("Arial", 14, QFont::Bold));
+    messageItem->setDefaultTextColor(COLOR_WAITING);
+    messageItem->setPos(MARGIN, MARGIN);
+    resize(640, 160);
+    showMessage("Подключение к " + host + "...");
+
+    socket = new QTcpSocket(this);
+    connect(socket, &QTcpSocket::connected, this, [this]() { sendMessage("JOIN:" + playerName); });
+    connect(socket, &QTcpSocket::readyRead, this, &FfaView::readData);
+    connect(socket, &QTcpSocket::disconnected, this, &FfaView::disconnected);
+    connect(socket, &QTcpSocket::errorOccurred, this, [this](QAbstractSocket::SocketError) {
+        showMessage("Ошибка соединения: " + socket->errorString());
+    });
+    socket->connectToHost(host, port);
+}
+
+void FfaView::sendMessage(const QString& message) {
+    if (socket->state() == QAbstractSocket::ConnectedState) socket->write((message + "\n").toUtf8());
+}
+
+void FfaView::readData() {
+    while (socket->canReadLine()) {
+        QString message = QString::fromUtf8(socket->readLine()).trimmed();
+        int colon = message.indexOf(':');
+        if (colon > 0) processCommand(message.left(colon), message.mid(colon + 1));
+    }
+}
+
+void FfaView::disconnected() {
+    if (!finished) showMessage("Соединение с сервером разорвано. Игра завершена.");
+    finished = true;
+}
+
+void FfaView::showMessage(const QString& message) {
+    messageItem->setPlainText(message);
+}
+
+void FfaView::processCommand(const QString& command, const QString& data) {
+    if (command == "WELCOME") {
+        QStringList f = data.split(',');
+        if (f.size() != 4 || myId >= 0) return;
+        const int id = f[0].toInt();
+        const int n = f[1].toInt();
+        const int players = f[3].toInt();
+        if (n < 8 || n > 12 || players < 2 || id < 0 || id >= players) return;
+        myId = id;
+        size = n;
+        expectedPlayers = players;
+        minesEnabled = f[2].toInt() != 0;
+        setupBoards();
+        shuffleFleet();
+        showMessage(QString("Расстановка: R - перемешать корабли, Enter - готов") +
+                    (minesEnabled ? ". На поля будут поставлены мины" : ""));
+    }
+    else if (command == "PLAYERS") {
+        for (const QString& entry : data.split(';', Qt::SkipEmptyParts)) {
+            int eq = entry.indexOf('=');
+            int id = entry.left(eq).toInt();
+            if (eq <= 0 || id < 0 || id >= int(boards.size())) continue;
+            boards[id].name = entry.mid(eq + 1);
+            updateTitle(id);
+        }
+    }
+    else if (command == "READY") {
+        int id = data.toInt();
+        if (id < 0 || id >= int(boards.size())) return;
+        boards[id].ready = true;
+        updateTitle(id);
+    }
+    else if (command == "START") {
+        started = true;
+        for (int id = 0; id < int(boards.size()); ++id) updateTitle(id);
+    }
+    else if (command == "TURN") {
+        int previous = turn;
+        turn = data.toInt();
+        if (previous >= 0 && previous < int(boards.size())) updateTitle(previous);
+        if (turn < 0 || turn >= int(boards.size())) return;
+        updateTitle(turn);
+        showMessage(turn == myId ? "Ваш ход: выберите клетку на поле любого соперника"
+                                 : "Ходит " + boards[turn].name);
+    }
+    else if (command == "SHOT") {
+        applyShot(data.split(','));
+    }
+    else if (command == "OUT") {
+        int id = data.toInt();
+        if (id < 0 || id >= int(boards.size())) return;
+        boards[id].alive = false;
+        updateTitle(id);
+        if (id == myId) showMessage("Ваш флот потоплен. Можно досмотреть партию.");
+    }
+    else if (command == "WINNER") {
+        int id = data.toInt();
+        if (id < 0 || id >= int(boards.size())) return;
+        finished = true;
+        int previous = turn;
+        turn = -1;
+        if (previous >= 0 && previous < int(boards.size())) updateTitle(previous);
+        showMessage(id == myId ? "Вы победили!" : "Победил " + boards[id].name);
+    }
+    else if (command == "FULL") {
+        finished = true;
+        showMessage("Все места в партии заняты.");
+    }
+}
+
+void FfaView::setupBoards() {
+    // Своё поле крупно слева, соперники - квадратной сеткой справа
+    const int ownCell = 320 / size;
+    const int opponentCell = 160 / size;
+    const int opponents = expectedPlayers - 1;
+    const int columns = int(std::ceil(std::sqrt(double(opponents))));
+    const int rows = (opponents + columns - 1) / columns;
+    const int stepX = size * opponentCell + 30;
+    const int stepY = size * opponentCell + TITLE_HEIGHT + 20;
+    const int opponentsX = MARGIN * 2 + size * ownCell;
+
+    boards.assign(expectedPlayers, Board());
+    for (int id = 0; id < expectedPlayers; ++id) {
+        Board& b = boards[id];
+        b.name = "...";
+        b.grid.assign(size, std::vector<Cell>(size, Empty));
+        b.sunk.assign(size, std::vector<bool>(size, false));
+        if (id == myId) {
+            b.cell = ownCell;
+            b.origin = QPointF(MARGIN, MARGIN + TITLE_HEIGHT);
+        } else {
+            const int slot = id < myId ? id : id - 1;
+            b.cell = opponentCell;
+            b.origin = QPointF(opponentsX + (slot % columns) * stepX,
+                               MARGIN + TITLE_HEIGHT + (slot / columns) * stepY);
+        }
+
+        b.frame = scene->addRect(b.origin.x() - 3, b.origin.y() - 3, size * b.cell + 4, size * b.cell + 4);
+        b.title = scene->addText(QString());
+        b.title->setFont(QFont("Arial", id == myId ? 14 : 9, QFont::Bold));
+        b.title->setPos(b.origin.x() - 4, b.origin.y() - TITLE_HEIGHT + (id == myId ? 0 : 6));
+
+        b.cells.resize(size * size);
+        for (int x = 0; x < size; ++x) {
+            for (int y = 0; y < size; ++y) {
+                QGraphicsRectItem *cell = scene->addRect(0, 0, b.cell - 2, b.cell - 2, Qt::NoPen, cellBrush(Empty, false));
+                cell->setPos(b.origin.x() + x * b.cell, b.origin.y() + y * b.cell);
+                b.cells[x * size + y] = cell;
+            }
+        }
+        updateTitle(id);
+    }
+
+    const int height = std::max(MARGIN + TITLE_HEIGHT + size * ownCell, MARGIN + TITLE_HEIGHT + rows * stepY) + 60;
+    const int width = opponentsX + columns * stepX + MARGIN;
+    messageItem->setPos(MARGIN, height - 50);
+    scene->setSceneRect(0, 0, width, height);
+    setFixedSize(width + 4, height + 4);
+}
+
+void FfaView::updateTitle(int id) {
+    Board& b = boards[id];
+    QString text = b.name;
+    if (id == myId) text += " (вы)";
+    if (!b.alive) text += " - выбыл";
+    else if (!started && b.ready) text += " - готов";
+
+    const QColor color = !b.alive ? QColor(Qt::gray) : id == myId ? COLOR_PLAYER_LABEL : COLOR_AI_LABEL;
+    b.title->setPlainText(text);
+    b.title->setDefaultTextColor(color);
+    b.frame->setPen(QPen(id == turn ? COLOR_TITLE : color, id == turn ? 3 : 1));
+}
+
+void FfaView::setCell(int id, int x, int y, Cell state) {
+    Board& b = boards[id];
+    b.grid[x][y] = state;
+    b.cells[x * size + y]->setBrush(cellBrush(state, b.sunk[x][y]));
+}
+
+void FfaView::markSunk(int id, int x, int y, int length) {
+    // Потопленный корабль ищем среди клетки выстрела и соседних (для мины)
+    Board& b = boards[id];
+    for (int dx = -1; dx <= 1; ++dx) {
+        for (int dy = -1; dy <= 1; ++dy) {
+            int nx = x + dx, ny = y + dy;
+            if (!rules::isInside(b.grid, nx, ny) || b.grid[nx][ny] != Hit || b.sunk[nx][ny]) continue;
+            auto cells = rules::getShipCells(b.grid, nx, ny);
+            if (int(cells.size()) != length) continue;
+            for (auto [cx, cy] : cells) {
+                b.sunk[cx][cy] = true;
+                setCell(id, cx, cy, Hit);
+            }
+            return;
+        }
+    }
+}
+
+void FfaView::applyShot(const QStringList& f) {
+    // стрелявший,цель,x,y,исход,маска,длины
+    if (f.size() != 7 || f[4].isEmpty()) return;
+    const int shooter = f[0].toInt();
+    const int target = f[1].toInt();
+    const int x = f[2].toInt();
+    const int y = f[3].toInt();
+    if (shooter < 0 || shooter >= int(boards.size()) || target < 0 || target >= int(boards.size())) return;
+    if (!rules::isInside(boards[target].grid, x, y)) return;
+
+    QString outcome;
+    const QChar kind = f[4][0];
+    if (kind == QLatin1Char('H')) {
+        setCell(target, x, y, Hit);
+        outcome = "попадание";
+    } else if (kind == QLatin1Char('M')) {
+        setCell(target, x, y, Miss);
+        outcome = "промах";
+    } else if (kind == QLatin1Char('X')) {
+        // Взрыв открыл соседние клетки: маска говорит, где были корабли
+        setCell(target, x, y, Mine);
+        const int mask = f[5].toInt();
+        for (int dx = -1; dx <= 1; ++dx) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                int nx = x + dx, ny = y + dy;
+                if ((dx == 0 && dy == 0) || !rules::isInside(boards[target].grid, nx, ny)) continue;
+                Cell current = boards[target].grid[nx][ny];
+                if (mask & (1 << neighbourBit(dx, dy))) setCell(target, nx, ny, Hit);
+                else if (current == Empty) setCell(target, nx, ny, Miss);
+            }
+        }
+        outcome = "мина!";
+    } else {
+        return;
+    }
+
+    const QStringList sizes = f[6].split('/', Qt::SkipEmptyParts);
+    for (const QString& length : sizes) markSunk(target, x, y, length.toInt());
+    if (!sizes.isEmpty()) outcome += ", корабль потоплен";
+
+    showMessage(QString("%1 -> %2, %3%4: %5").arg(boards[shooter].name, boards[target].name)
+                    .arg(QChar('A' + x)).arg(y + 1).arg(outcome));
+}
+
+void FfaView::shuffleFleet() {
+    Grid grid(size, std::vector<Cell>(size, Empty));
+    rules::placeFleetRandomly(grid, rules::shipSizes(rules::fleetFor(size)), rng);
+    for (int x = 0; x < size; ++x)
+        for (int y = 0; y < size; ++y) setCell(myId, x, y, grid[x][y]);
+}
+
+void FfaView::mousePressEvent(QMouseEvent *event) {
+    if (!started || finished || turn != myId || event->button() != Qt::LeftButton) return;
+
+    const QPointF pos = mapToScene(event->pos());
+    for (int id = 0; id < int(boards.size()); ++id) {
+        const Board& b = boards[id];
+        if (id == myId || !b.alive) continue;
+        const int x = int(std::floor((pos.x() - b.origin.x()) / b.cell));
+        const int y = int(std::floor((pos.y() - b.origin.y()) / b.cell));
+        if (!rules::isInside(b.grid, x, y)) continue;
+        if (b.grid[x][y] == Empty) {
+            sendMessage(QString("SHOT:%1,%2,%3").arg(id).arg(x).arg(y));
+        }
+        return;
+    }
+}
+
+void FfaView::keyPressEvent(QKeyEvent *event) {
+    const bool placingFleet = myId >= 0 && size > 0 && !fleetSent && !finished;
+    if (placingFleet && (event->key() == Qt::Key_R || event->key() == 1050)) {
+        shuffleFleet();
+    } else if (placingFleet && (event->key() == Qt::Key_Return || event->key() == Qt::Key_Enter)) {
+        QString fleet;
+        fleet.reserve(size * size);
+        for (int y = 0; y < size; ++y)
+            for (int x = 0; x < size; ++x) fleet += QLatin1Char(boards[myId].grid[x][y] == Ship ? 'S' : '.');
+        sendMessage("FLEET:" + fleet);
+        fleetSent = true;
+        showMessage("Флот отправлен. Ждём остальных игроков...");
+    } else {
+        QGraphicsView::keyPressEvent(event);
+    }
+}
@@ -0,0 +1,71 @@
+// ffaview.h
+#ifndef FFAVIEW_H
+#define FFAVIEW_H
+
+#include "gametypes.h"
+#include <QGraphicsRectItem>
+#include <QGraphicsScene>
+#include <QGraphicsTextItem>
+#include <QGraphicsView>
+#include <QTcpSocket>
+#include <random>
+#include <vector>
+
+// Клиент партии "все против всех": своё поле слева, поля соперников сеткой справа.
+// Клетки каждого поля - постоянные элементы сцены; событие меняет кисть только
+// затронутых клеток, рамку хода и подпись, сцена целиком не перерисовывается
+class FfaView : public QGraphicsView {
+    Q_OBJECT
+public:
+    FfaView(const QString& host, quint16 port, const QString& name, QWidget *parent = nullptr);
+
+protected:
+    void mousePressEvent(QMouseEvent *event) override;
+    void keyPressEvent(QKeyEvent *event) override;
+
+private slots:
+    void readData();
+    void disconnected();
+
+private:
+    struct Board {
+        QString name;
+        Grid grid;                      // что известно о поле; у своего - и корабли
+        std::vector<std::vector<bool>> sunk;
+        QPointF origin;
+        int cell = 0;
+        bool alive = true;
+        bool ready = false;
+        QGraphicsRectItem *frame = nullptr;
+        QGraphicsTextItem *title = nullptr;
+        std::vector<QGraphicsRectItem *> cells;     // x * size + y
+    };
+
+    QTcpSocket *socket;
+    QGraphicsScene *scene;
+    QGraphicsTextItem *messageItem = nullptr;
+    QString playerName;
+    std::mt19937 rng;
+
+    int myId = -1;
+    int size = 0;
+    int expectedPlayers = 0;
+    bool minesEnabled = false;
+    bool fleetSent = false;
+    bool started = false;
+    bool finished = false;
+    int turn = -1;
+    std::vector<Board> boards;          // по id игрока
+
+    void processCommand(const QString& command, const QString& data);
+    void sendMessage(const QString& message);
+    void setupBoards();
+    void updateTitle(int id);
+    void setCell(int id, int x, int y, Cell state);
+    void markSunk(int id, int x, int y, int length);
+    void applyShot(const QStringList& fields);
+    void shuffleFleet();
+    void showMessage(const QString& message);
+};
+
+#endif // FFAVIEW_H
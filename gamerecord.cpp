@@ -0,0 +1,273 @@
+#include "gamerecord.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+const char RECORD_MAGIC[8] = {'S', 'E', 'A', 'R', 'E', 'C', 0, 0};
+const size_t FILE_HEADER_SIZE = 16;
+const uint8_t UNKNOWN_MINE = 0xFF;
+
+size_t maskBytesFor(int gridSize) {
+    return (size_t(gridSize) * gridSize + 7) / 8;
+}
+
+bool testBit(const uint8_t *mask, int i) {
+    return (mask[i >> 3] >> (i & 7)) & 1;
+}
+
+void setBit(uint8_t *mask, int i) {
+    mask[i >> 3] |= uint8_t(1 << (i & 7));
+}
+
+void appendBytes(std::vector<uint8_t>& out, const void *data, size_t size) {
+    auto bytes = static_cast<const uint8_t *>(data);
+    out.insert(out.end(), bytes, bytes + size);
+}
+
+// Маски открытых клеток обоих полей: ключевой кадр
+void appendKeyframe(std::vector<uint8_t>& out, const Grid boards[2], int n) {
+    for (int side = 0; side < 2; ++side) {
+        std::vector<uint8_t> mask(maskBytesFor(n), 0);
+        for (int x = 0; x < n; ++x)
+            for (int y = 0; y < n; ++y)
+                if (boards[side][x][y] == Hit || boards[side][x][y] == Miss) setBit(mask.data(), y * n + x);
+        appendBytes(out, mask.data(), mask.size());
+    }
+}
+
+} // namespace
+
+void GameRecordBuilder::begin(int size, bool withMines, int first, uint32_t time) {
+    active = true;
+    gridSize = size;
+    mines = withMines;
+    firstPlayer = first;
+    startTime = time;
+    shots.clear();
+    for (int side = 0; side < 2; ++side) {
+        boards[side].assign(size, std::vector<Cell>(size, Empty));
+        partial[side] = false;
+    }
+}
+
+void GameRecordBuilder::setBoard(int side, const Grid& board, bool isPartial) {
+    boards[side] = board;
+    partial[side] = isPartial;
+}
+
+void GameRecordBuilder::addShot(const rules::ShotEvent& shot) {
+    if (active) shots.push_back(shot);
+}
+
+std::vector<uint8_t> GameRecordBuilder::finish(int winner) {
+    active = false;
+    const int n = gridSize;
+    const size_t maskBytes = maskBytesFor(n);
+    const size_t shotCount = std::min<size_t>(shots.size(), 0xFFFF);
+
+    std::vector<int> mineCells[2];
+    for (int side = 0; side < 2; ++side)
+        for (int y = 0; y < n; ++y)
+            for (int x = 0; x < n; ++x)
+                if (boards[side][x][y] == Mine) mineCells[side].push_back(y * n + x);
+    const size_t mineCount = std::min<size_t>(255, std::max(mineCells[0].size(), mineCells[1].size()));
+
+    RecordHeader header{};
+    header.gridSize = uint8_t(n);
+    header.flags = uint8_t((mines ? RecordMines : 0) | (firstPlayer ? RecordSecondMovesFirst : 0) |
+                           ((winner + 1) << RecordWinnerShift) |
+                           (partial[0] ? RecordPartial0 : 0) | (partial[1] ? RecordPartial1 : 0));
+    header.mineCount = uint8_t(mineCount);
+    header.keyframeInterval = RECORD_KEYFRAME_INTERVAL;
+    header.shotCount = uint16_t(shotCount);
+    header.keyframeCount = uint16_t(shotCount / RECORD_KEYFRAME_INTERVAL);
+    header.startTime = startTime;
+
+    std::vector<uint8_t> out(sizeof(RecordHeader));
+    out.reserve(sizeof(RecordHeader) + 2 * maskBytes + 2 * mineCount + 2 * shotCount +
+                header.keyframeCount * 2 * maskBytes);
+
+    for (int side = 0; side < 2; ++side) {
+        std::vector<uint8_t> mask(maskBytes, 0);
+        for (int x = 0; x < n; ++x)
+            for (int y = 0; y < n; ++y)
+                if (boards[side][x][y] == Ship) setBit(mask.data(), y * n + x);
+        appendBytes(out, mask.data(), mask.size());
+    }
+    for (int side = 0; side < 2; ++side) {
+        for (size_t i = 0; i < mineCount; ++i)
+            out.push_back(i < mineCells[side].size() ? uint8_t(mineCells[side][i]) : UNKNOWN_MINE);
+    }
+
+    // Выстрел в 16 битах: клетка, кто стрелял, исход и число потопленных им кораблей
+    for (size_t i = 0; i < shotCount; ++i) {
+        const rules::ShotEvent& s = shots[i];
+        uint16_t packed = uint16_t(s.y * n + s.x) | uint16_t(s.player << 8) |
+                          uint16_t(s.kind << 9) | uint16_t(std::min<int>(s.sunkCount, 3) << 11);
+        out.push_back(uint8_t(packed));
+        out.push_back(uint8_t(packed >> 8));
+    }
+
+    // Кадры считаются тем же разбором выстрелов, что и в игре
+    Grid replay[2] = {boards[0], boards[1]};
+    for (size_t i = 0; i < shotCount; ++i) {
+        const rules::ShotEvent& s = shots[i];
+        Grid& defender = replay[1 - s.player];
+        if (rules::isInside(defender, s.x, s.y)) rules::resolveShot(defender, s.x, s.y);
+        if ((i + 1) % RECORD_KEYFRAME_INTERVAL == 0) appendKeyframe(out, replay, n);
+    }
+
+    header.size = uint32_t(out.size());
+    std::memcpy(out.data(), &header, sizeof(header));
+    return out;
+}
+
+RecordWriter::RecordWriter(const std::string& path) : path(path), thread(&RecordWriter::run, this) {}
+
+RecordWriter::~RecordWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    thread.join();
+}
+
+void RecordWriter::append(const std::vector<uint8_t>& record) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.insert(pending.end(), record.begin(), record.end());
+        appended += record.size();
+    }
+    wake.notify_one();
+}
+
+void RecordWriter::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    written.wait(lock, [this] { return flushed == appended; });
+}
+
+void RecordWriter::run() {
+    std::FILE *file = std::fopen(path.c_str(), "ab");
+    if (file && std::fseek(file, 0, SEEK_END) == 0 && std::ftell(file) == 0) {
+        uint8_t header[FILE_HEADER_SIZE] = {};
+        std::memcpy(header, RECORD_MAGIC, sizeof(RECORD_MAGIC));
+        std::memcpy(header + 8, &GAME_RECORD_VERSION, sizeof(GAME_RECORD_VERSION));
+        std::fwrite(header, 1, sizeof(header), file);
+        std::fflush(file);
+    }
+
+    std::vector<uint8_t> chunk;
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        wake.wait(lock, [this] { return stopping || !pending.empty(); });
+        if (pending.empty() && stopping) break;
+
+        // Диск - без блокировки: тем временем append копит следующий буфер
+        chunk.swap(pending);
+        lock.unlock();
+        if (file) {
+            std::fwrite(chunk.data(), 1, chunk.size(), file);
+            std::fflush(file);
+        }
+        size_t done = chunk.size();
+        chunk.clear();
+        lock.lock();
+        flushed += done;
+        written.notify_all();
+    }
+    lock.unlock();
+    if (file) std::fclose(file);
+}
+
+rules::ShotEvent RecordedGame::shot(int move) const {
+    const uint8_t *p = shots + size_t(move) * 2;
+    uint16_t packed = uint16_t(p[0] | (p[1] << 8));
+    const int n = header.gridSize;
+    int cell = packed & 0xFF;
+    return {uint8_t((packed >> 8) & 1), uint8_t(cell % n), uint8_t(cell / n),
+            rules::ShotResult::Kind((packed >> 9) & 3), uint8_t((packed >> 11) & 3)};
+}
+
+Grid RecordedGame::initialBoard(int side) const {
+    const int n = header.gridSize;
+    Grid board(n, std::vector<Cell>(n, Empty));
+    const uint8_t *mask = fleets + side * maskBytes;
+    for (int y = 0; y < n; ++y)
+        for (int x = 0; x < n; ++x)
+            if (testBit(mask, y * n + x)) board[x][y] = Ship;
+    const uint8_t *m = minesData + side * header.mineCount;
+    for (int i = 0; i < header.mineCount; ++i) {
+        if (m[i] != UNKNOWN_MINE && m[i] < n * n) board[m[i] % n][m[i] / n] = Mine;
+    }
+    return board;
+}
+
+void RecordedGame::boardsAt(int move, Grid boards[2]) const {
+    const int n = header.gridSize;
+    move = std::clamp(move, 0, int(header.shotCount));
+    boards[0] = initialBoard(0);
+    boards[1] = initialBoard(1);
+
+    int from = 0;
+    int frame = std::min<int>(move / header.keyframeInterval, header.keyframeCount);
+    if (frame > 0) {
+        const uint8_t *kf = keyframes + size_t(frame - 1) * 2 * maskBytes;
+        for (int side = 0; side < 2; ++side) {
+            const uint8_t *mask = kf + side * maskBytes;
+            for (int y = 0; y < n; ++y) {
+                for (int x = 0; x < n; ++x) {
+                    if (!testBit(mask, y * n + x)) continue;
+                    boards[side][x][y] = boards[side][x][y] == Ship ? Hit : Miss;
+                }
+            }
+        }
+        from = frame * header.keyframeInterval;
+    }
+
+    for (int i = from; i < move; ++i) {
+        rules::ShotEvent s = shot(i);
+        Grid& defender = boards[1 - s.player];
+        if (rules::isInside(defender, s.x, s.y)) rules::resolveShot(defender, s.x, s.y);
+    }
+}
+
+bool GameArchive::attach(const void *data, size_t size) {
+    base = static_cast<const uint8_t *>(data);
+    offsets.clear();
+    if (!base || size < FILE_HEADER_SIZE || std::memcmp(base, RECORD_MAGIC, sizeof(RECORD_MAGIC)) != 0)
+        return false;
+    uint32_t version;
+    std::memcpy(&version, base + 8, sizeof(version));
+    if (version != GAME_RECORD_VERSION) return false;
+
+    // Проходим только по длинам записей; оборванная последняя запись отбрасывается
+    size_t offset = FILE_HEADER_SIZE;
+    while (offset + sizeof(RecordHeader) <= size) {
+        RecordHeader h;
+        std::memcpy(&h, base + offset, sizeof(h));
+        const size_t maskBytes = maskBytesFor(h.gridSize);
+        const size_t expected = sizeof(RecordHeader) + 2 * maskBytes + 2 * size_t(h.mineCount) +
+                                2 * size_t(h.shotCount) + size_t(h.keyframeCount) * 2 * maskBytes;
+        if (h.gridSize == 0 || h.gridSize > 15 || h.keyframeInterval == 0 || h.size != expected ||
+            offset + h.size > size)
+            break;
+        offsets.push_back(offset);
+        offset += h.size;
+    }
+    return true;
+}
+
+RecordedGame GameArchive::game(size_t index) const {
+    RecordedGame g;
+    const uint8_t *p = base + offsets[index];
+    std::memcpy(&g.header, p, sizeof(g.header));
+    g.maskBytes = maskBytesFor(g.header.gridSize);
+    g.fleets = p + sizeof(RecordHeader);
+    g.minesData = g.fleets + 2 * g.maskBytes;
+    g.shots = g.minesData + 2 * g.header.mineCount;
+    g.keyframes = g.shots + 2 * size_t(g.header.shotCount);
+    return g;
+}
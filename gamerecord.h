@@ -0,0 +1,141 @@
+// gamerecord.h
+#ifndef GAMERECORD_H
+#define GAMERECORD_H
+
+#include "gamerules.h"
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Архив партий - файл только для дописывания (little-endian):
+//   заголовок файла: "SEAREC" + 2 нуля, uint32 версия, uint32 резерв;
+//   затем записи партий подряд. Запись партии:
+//   RecordHeader (16 байт),
+//   поля обеих сторон до первого выстрела - битовые маски кораблей (бит y * size + x),
+//   номера клеток мин каждой стороны (по байту),
+//   shotCount выстрелов по 2 байта,
+//   ключевые кадры: через каждые RECORD_KEYFRAME_INTERVAL выстрелов - маски
+//   открытых клеток обоих полей.
+// Позиция после любого выстрела восстанавливается по ближайшему кадру
+// и не более чем RECORD_KEYFRAME_INTERVAL - 1 выстрелам.
+const uint32_t GAME_RECORD_VERSION = 1;
+const int RECORD_KEYFRAME_INTERVAL = 32;
+
+// Флаги RecordHeader::flags
+enum RecordFlag : uint8_t {
+    RecordMines = 1,
+    RecordSecondMovesFirst = 2,
+    RecordWinnerShift = 2,       // биты 2-3: 0 - партия не доиграна, 1 - сторона 0, 2 - сторона 1
+    RecordPartial0 = 16,         // поле стороны известно не полностью (сетевой соперник)
+    RecordPartial1 = 32
+};
+
+struct RecordHeader {
+    uint32_t size;               // длина всей записи в байтах
+    uint8_t gridSize;
+    uint8_t flags;
+    uint8_t mineCount;           // мин на каждом поле
+    uint8_t keyframeInterval;
+    uint16_t shotCount;
+    uint16_t keyframeCount;
+    uint32_t startTime;          // Unix time начала партии
+};
+
+static_assert(sizeof(RecordHeader) == 16, "record header layout");
+
+// Собирает одну партию и превращает её в запись архива
+class GameRecordBuilder {
+public:
+    // Сторона 0 - записывающий игрок (или первый участник симулятора)
+    void begin(int gridSize, bool mines, int firstPlayer, uint32_t startTime);
+    // Поле до первого выстрела; partial - известны только найденные корабли и мины
+    void setBoard(int side, const Grid& board, bool partial = false);
+    void addShot(const rules::ShotEvent& shot);
+    bool isActive() const { return active; }
+
+    // winner: 0, 1 или -1, если партия не доиграна
+    std::vector<uint8_t> finish(int winner);
+
+private:
+    bool active = false;
+    int gridSize = 0;
+    bool mines = false;
+    int firstPlayer = 0;
+    uint32_t startTime = 0;
+    Grid boards[2];
+    bool partial[2] = {false, false};
+    std::vector<rules::ShotEvent> shots;
+};
+
+// Дописывает записи в файл из своего потока: append только копирует байты
+// в буфер, поэтому поток GUI и сети на диске не ждёт
+class RecordWriter {
+public:
+    explicit RecordWriter(const std::string& path);
+    ~RecordWriter();
+
+    RecordWriter(const RecordWriter&) = delete;
+    RecordWriter& operator=(const RecordWriter&) = delete;
+
+    void append(const std::vector<uint8_t>& record);
+    // Ждёт, пока всё добавленное окажется в файле
+    void flush();
+
+private:
+    std::string path;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable written;
+    std::vector<uint8_t> pending;
+    uint64_t appended = 0;
+    uint64_t flushed = 0;
+    bool stopping = false;
+    std::thread thread;
+
+    void run();
+};
+
+// Одна партия архива; данные не копируются
+class RecordedGame {
+public:
+    int gridSize() const { return header.gridSize; }
+    bool mines() const { return header.flags & RecordMines; }
+    int firstPlayer() const { return (header.flags & RecordSecondMovesFirst) ? 1 : 0; }
+    int winner() const { return ((header.flags >> RecordWinnerShift) & 3) - 1; }
+    bool partial(int side) const { return header.flags & (side ? RecordPartial1 : RecordPartial0); }
+    int shotCount() const { return header.shotCount; }
+    uint32_t startTime() const { return header.startTime; }
+
+    // Выстрел с номером move, O(1)
+    rules::ShotEvent shot(int move) const;
+    Grid initialBoard(int side) const;
+    // Поля после первых move выстрелов (0 - до начала): кадр плюс не больше интервала выстрелов
+    void boardsAt(int move, Grid boards[2]) const;
+
+private:
+    friend class GameArchive;
+    RecordHeader header{};
+    const uint8_t *fleets = nullptr;
+    const uint8_t *minesData = nullptr;
+    const uint8_t *shots = nullptr;
+    const uint8_t *keyframes = nullptr;
+    size_t maskBytes = 0;
+};
+
+// Чтение архива прямо из отображённой памяти
+class GameArchive {
+public:
+    bool attach(const void *data, size_t size);
+    size_t gameCount() const { return offsets.size(); }
+    RecordedGame game(size_t index) const;
+
+private:
+    const uint8_t *base = nullptr;
+    std::vector<size_t> offsets;
+};
+
+#endif // GAMERECORD_H
@@ -0,0 +1,273 @@
+#include "gamerules.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace rules {
+
+std::vector<FleetEntry> fleetFor(int gridSize) {
+    switch (gridSize) {
+    case 8:
+        return {
+            {3, 1, "Линкор"},
+            {2, 2, "Крейсер"},
+            {1, 3, "Катер"}
+        };
+    case 12:
+        return {
+            {5, 1, "Авианосец"},
+            {4, 1, "Линкор"},
+            {3, 2, "Крейсер"},
+            {2, 3, "Эсминец"},
+            {1, 4, "Катер"}
+        };
+    case 10:
+    default:
+        return {
+            {4, 1, "Линкор"},
+            {3, 2, "Крейсер"},
+            {2, 3, "Эсминец"},
+            {1, 4, "Катер"}
+        };
+    }
+}
+
+std::vector<int> shipSizes(const std::vector<FleetEntry>& fleet) {
+    std::vector<int> sizes;
+    for (const auto& s : fleet) {
+        for (int i = 0; i < s.count; ++i) sizes.push_back(s.size);
+    }
+    return sizes;
+}
+
+bool isInside(const Grid& grid, int x, int y) {
+    int n = int(grid.size());
+    return x >= 0 && y >= 0 && x < n && y < n;
+}
+
+bool isSurroundingClear(const Grid& grid, int x, int y, int size, bool horizontal) {
+    for (int i = -1; i <= size; ++i) {
+        for (int j = -1; j <= 1; ++j) {
+            int nx = x + (horizontal ? i : j);
+            int ny = y + (horizontal ? j : i);
+            if (isInside(grid, nx, ny) && grid[nx][ny] != Empty && grid[nx][ny] != Mine) // Игнорируем мины
+                return false;
+        }
+    }
+    return true;
+}
+
+bool canPlace(const Grid& grid, int x, int y, int size, bool horizontal) {
+    for (int i = 0; i < size; ++i) {
+        int px = x + (horizontal ? i : 0);
+        int py = y + (horizontal ? 0 : i);
+        if (!isInside(grid, px, py) || (grid[px][py] != Empty && grid[px][py] != Mine)) // Разрешаем ставить на мины
+            return false;
+    }
+    return true;
+}
+
+void placeShip(Grid& grid, int x, int y, int size, bool horizontal) {
+    for (int i = 0; i < size; ++i) {
+        int px = x + (horizontal ? i : 0);
+        int py = y + (horizontal ? 0 : i);
+        grid[px][py] = Ship; // Если здесь была мина, она будет заменена на корабль
+    }
+}
+
+std::vector<std::pair<int, int>> getShipCells(const Grid& grid, int x, int y) {
+    std::vector<std::pair<int, int>> cells;
+    if (grid[x][y] != Hit) return cells;
+    const int n = int(grid.size());
+
+    int startX = x;
+    while (startX > 0 && grid[startX - 1][y] == Hit) --startX;
+    int endX = x;
+    while (endX + 1 < n && grid[endX + 1][y] == Hit) ++endX;
+    if (endX - startX >= 1) {
+        for (int i = startX; i <= endX; ++i) cells.emplace_back(i, y);
+        return cells;
+    }
+
+    int startY = y;
+    while (startY > 0 && grid[x][startY - 1] == Hit) --startY;
+    int endY = y;
+    while (endY + 1 < n && grid[x][endY + 1] == Hit) ++endY;
+    if (endY - startY >= 1) {
+        for (int i = startY; i <= endY; ++i) cells.emplace_back(x, i);
+        return cells;
+    }
+
+    cells.emplace_back(x, y);
+    return cells;
+}
+
+bool isShipSunk(const Grid& grid, int x, int y) {
+    auto cells = getShipCells(grid, x, y);
+    for (auto& [cx, cy] : cells) {
+        for (int dx = -1; dx <= 1; ++dx) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                if (abs(dx) + abs(dy) != 1) continue;
+                int nx = cx + dx, ny = cy + dy;
+                if (isInside(grid, nx, ny) && grid[nx][ny] == Ship)
+                    return false;
+            }
+        }
+    }
+    return true;
+}
+
+void placeMines(Grid& grid, int count, std::mt19937& rng) {
+    std::uniform_int_distribution<> dis(0, int(grid.size()) - 1);
+
+    int placed = 0;
+    while (placed < count) {
+        int x = dis(rng);
+        int y = dis(rng);
+
+        if (grid[x][y] == Empty) {
+            grid[x][y] = Mine;
+            placed++;
+        }
+    }
+}
+
+void placeFleetRandomly(Grid& grid, const std::vector<int>& sizes, std::mt19937& rng) {
+    std::uniform_int_distribution<> dis(0, int(grid.size()) - 1);
+    std::bernoulli_distribution orientation(0.5);
+
+    for (int size : sizes) {
+        // Сначала пробуем классическую расстановку без касаний, потом любую допустимую
+        for (int attempt = 0; ; ++attempt) {
+            int x = dis(rng);
+            int y = dis(rng);
+            bool h = orientation(rng);
+            if (canPlace(grid, x, y, size, h) &&
+                (attempt > 1000 || isSurroundingClear(grid, x, y, size, h))) {
+                placeShip(grid, x, y, size, h);
+                break;
+            }
+        }
+    }
+}
+
+ShotResult resolveShot(Grid& grid, int x, int y) {
+    ShotResult result;
+
+    if (grid[x][y] == Ship) {
+        grid[x][y] = Hit;
+        result.kind = ShotResult::Hit;
+        result.shipCellsHit.emplace_back(x, y);
+
+        // Проверяем, не потоплен ли корабль
+        if (isShipSunk(grid, x, y)) {
+            result.sunkShips.push_back(getShipCells(grid, x, y));
+        }
+    }
+    else if (grid[x][y] == Mine) {
+        result.kind = ShotResult::MineHit;
+        grid[x][y] = Miss;
+
+        // Взрыв мины - поражаем соседние клетки
+        for (int dx = -1; dx <= 1; ++dx) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                if (dx == 0 && dy == 0) continue;
+                int nx = x + dx;
+                int ny = y + dy;
+                if (isInside(grid, nx, ny)) {
+                    if (grid[nx][ny] == Ship) {
+                        grid[nx][ny] = Hit;
+                        result.shipCellsHit.emplace_back(nx, ny);
+                        if (isShipSunk(grid, nx, ny)) {
+                            result.sunkShips.push_back(getShipCells(grid, nx, ny));
+                        }
+                    }
+                    // Пустые клетки и мины отмечаем промахом: иначе они сливаются
+                    // с подбитыми кораблями, и потопление уже не распознаётся
+                    else if (grid[nx][ny] == Empty || grid[nx][ny] == Mine) {
+                        grid[nx][ny] = Miss;
+                    }
+                }
+            }
+        }
+    }
+    else if (grid[x][y] == Empty) {
+        grid[x][y] = Miss;
+        result.kind = ShotResult::Miss;
+    }
+
+    return result;
+}
+
+int mineBlastBit(int dx, int dy) {
+    // Центр - сама мина, он пропускается: восемь соседей укладываются в восемь бит
+    int bit = (dx + 1) * 3 + (dy + 1);
+    return bit > 4 ? bit - 1 : bit;
+}
+
+int mineBlastMask(int x, int y, const ShotResult& result) {
+    int mask = 0;
+    if (result.kind != ShotResult::MineHit) return mask;
+    for (auto [cx, cy] : result.shipCellsHit) mask |= 1 << mineBlastBit(cx - x, cy - y);
+    return mask;
+}
+
+int salvoSize(int shipsAfloat) {
+    return std::max(1, shipsAfloat);
+}
+
+std::vector<ShotResult> resolveSalvo(Grid& grid, const std::vector<std::pair<int, int>>& shots) {
+    const int n = int(grid.size());
+    std::vector<ShotResult> results(shots.size());
+    // Какой выстрел залпа последним подбил клетку корабля
+    std::vector<int> hitBy(size_t(n) * n, -1);
+
+    auto hitShip = [&](ShotResult& result, int x, int y, int shot) {
+        grid[x][y] = Hit;
+        result.shipCellsHit.emplace_back(x, y);
+        hitBy[size_t(y) * n + x] = shot;
+    };
+
+    for (size_t i = 0; i < shots.size(); ++i) {
+        auto [x, y] = shots[i];
+        ShotResult& result = results[i];
+        if (!isInside(grid, x, y)) continue;
+
+        // Повтор внутри залпа находит уже открытую клетку и даёт Repeat
+        if (grid[x][y] == Ship) {
+            result.kind = ShotResult::Hit;
+            hitShip(result, x, y, int(i));
+        } else if (grid[x][y] == Mine) {
+            result.kind = ShotResult::MineHit;
+            grid[x][y] = Miss;
+            for (int dx = -1; dx <= 1; ++dx) {
+                for (int dy = -1; dy <= 1; ++dy) {
+                    int nx = x + dx, ny = y + dy;
+                    if ((dx == 0 && dy == 0) || !isInside(grid, nx, ny)) continue;
+                    if (grid[nx][ny] == Ship) hitShip(result, nx, ny, int(i));
+                    else if (grid[nx][ny] == Empty || grid[nx][ny] == Mine) grid[nx][ny] = Miss;
+                }
+            }
+        } else if (grid[x][y] == Empty) {
+            result.kind = ShotResult::Miss;
+            grid[x][y] = Miss;
+        }
+    }
+
+    // Потопления - по одному разу на корабль, когда все клетки залпа уже открыты
+    std::vector<bool> checked(size_t(n) * n, false);
+    for (const auto& result : results) {
+        for (auto [x, y] : result.shipCellsHit) {
+            if (checked[size_t(y) * n + x]) continue;
+            auto cells = getShipCells(grid, x, y);
+            int last = -1;
+            for (auto [cx, cy] : cells) {
+                checked[size_t(cy) * n + cx] = true;
+                last = std::max(last, hitBy[size_t(cy) * n + cx]);
+            }
+            if (isShipSunk(grid, x, y)) results[size_t(last)].sunkShips.push_back(std::move(cells));
+        }
+    }
+    return results;
+}
+
+} // namespace rules
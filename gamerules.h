@@ -0,0 +1,73 @@
+// gamerules.h
+#ifndef GAMERULES_H
+#define GAMERULES_H
+
+#include "gametypes.h"
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+// Правила игры без Qt: расстановка, мины и разбор выстрела.
+// Ими пользуются и BattleShipGame (processCommand), и симулятор,
+// поэтому исход любого выстрела в обоих одинаков.
+namespace rules {
+
+struct FleetEntry {
+    int size;
+    int count;
+    const char *name;
+};
+
+// Состав флота для GameSize
+std::vector<FleetEntry> fleetFor(int gridSize);
+// Размеры всех кораблей флота по одному на корабль, от больших к меньшим
+std::vector<int> shipSizes(const std::vector<FleetEntry>& fleet);
+
+bool isInside(const Grid& grid, int x, int y);
+bool isSurroundingClear(const Grid& grid, int x, int y, int size, bool horizontal);
+bool canPlace(const Grid& grid, int x, int y, int size, bool horizontal);
+void placeShip(Grid& grid, int x, int y, int size, bool horizontal);
+std::vector<std::pair<int, int>> getShipCells(const Grid& grid, int x, int y);
+bool isShipSunk(const Grid& grid, int x, int y);
+
+void placeMines(Grid& grid, int count, std::mt19937& rng);
+// Случайная расстановка: сначала без касаний, если не выходит - любая допустимая
+void placeFleetRandomly(Grid& grid, const std::vector<int>& sizes, std::mt19937& rng);
+
+struct ShotResult {
+    enum Kind { Repeat, Miss, Hit, MineHit };
+    Kind kind = Repeat;
+    std::vector<std::pair<int, int>> shipCellsHit;              // клетки кораблей, подбитые этим выстрелом
+    std::vector<std::vector<std::pair<int, int>>> sunkShips;    // потопленные им корабли по порядку
+};
+
+// Выстрел по полю защищающегося: меняет поле так же, как processCommand("SHOT")
+ShotResult resolveShot(Grid& grid, int x, int y);
+
+// Что стрелявший узнаёт о взрыве мины в (x, y): бит mineBlastBit(dx, dy) на каждую
+// соседнюю клетку, где взрыв подбил корабль; остальные клетки области 3x3 - промахи.
+// Так исход мины передаётся по сети (MINE_HIT, SALVO_RESULT) и так его видит симулятор
+int mineBlastMask(int x, int y, const ShotResult& result);
+int mineBlastBit(int dx, int dy);
+
+// Режим залпов: за ход столько выстрелов, сколько у стреляющего кораблей на плаву
+int salvoSize(int shipsAfloat);
+
+// Залп разбирается одним проходом: сначала открываются клетки всех выстрелов,
+// затем потопление проверяется один раз для каждого задетого корабля. Корабль,
+// добитый несколькими выстрелами залпа, засчитывается последнему из них.
+// Для залпа из одного выстрела исход тот же, что у resolveShot
+std::vector<ShotResult> resolveSalvo(Grid& grid, const std::vector<std::pair<int, int>>& shots);
+
+// Один выстрел партии - нужен тем, кто записывает или анализирует игры
+struct ShotEvent {
+    uint8_t player;
+    uint8_t x, y;
+    ShotResult::Kind kind;
+    uint8_t sunkCount;
+};
+
+} // namespace rules
+
+#endif // GAMERULES_H
@@ -0,0 +1,12 @@
+// gametypes.h
+#ifndef GAMETYPES_H
+#define GAMETYPES_H
+
+#include <vector>
+
+// Общие типы игрового поля, не зависящие от Qt (используются и GUI, и ИИ)
+enum Cell { Empty, Ship, Hit, Miss, Mine };
+
+using Grid = std::vector<std::vector<Cell>>;
+
+#endif // GAMETYPES_H
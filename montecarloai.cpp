@@ -0,0 +1,237 @@
+#include "montecarloai.h"
+#include "battleshipai.h"
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <random>
+
+namespace {
+
+struct Placement {
+    int x, y, len;
+    bool horizontal;
+};
+
+uint64_t rowMask(int n) {
+    return n >= 64 ? ~uint64_t(0) : ((uint64_t(1) << n) - 1);
+}
+
+uint64_t mix(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+// Общие для всех задач данные хода, только для чтения
+struct SampleContext {
+    int n;
+    std::vector<uint64_t> free;     // не промах и не потопленный корабль
+    std::vector<uint64_t> hit;      // открытые попадания
+    std::vector<uint64_t> known;    // уже стреляли
+    std::vector<int> ships;         // оставшиеся корабли по убыванию
+    std::map<int, std::vector<Placement>> placements;
+
+    // Помещается ли корабль: все клетки свободны, не заняты и не все уже подбиты
+    bool fits(const Placement& p, const std::vector<uint64_t>& occ) const {
+        if (p.x < 0 || p.y < 0) return false;
+        if (p.horizontal) {
+            if (p.x + p.len > n) return false;
+            uint64_t m = rowMask(p.len) << p.x;
+            return (free[p.y] & m) == m && !(occ[p.y] & m) && (m & ~hit[p.y]);
+        }
+        if (p.y + p.len > n) return false;
+        uint64_t bit = uint64_t(1) << p.x;
+        bool fresh = false;
+        for (int i = 0; i < p.len; ++i) {
+            int y = p.y + i;
+            if (!(free[y] & bit) || (occ[y] & bit)) return false;
+            if (!(hit[y] & bit)) fresh = true;
+        }
+        return fresh;
+    }
+
+    static void place(const Placement& p, std::vector<uint64_t>& occ) {
+        if (p.horizontal) {
+            occ[p.y] |= rowMask(p.len) << p.x;
+        } else {
+            for (int i = 0; i < p.len; ++i) occ[p.y + i] |= uint64_t(1) << p.x;
+        }
+    }
+};
+
+// Одна случайная расстановка. Сначала корабли ставятся через случайные непокрытые
+// попадания, затем остальные - в случайные свободные места.
+bool sampleLayout(const SampleContext& ctx, std::mt19937_64& rng, std::vector<uint64_t>& occ,
+                  std::vector<int>& ships, std::vector<Placement>& candidates) {
+    const int n = ctx.n;
+    occ.assign(n, 0);
+    ships = ctx.ships;
+    std::vector<uint64_t> uncovered = ctx.hit;
+
+    for (;;) {
+        int hits = 0;
+        for (uint64_t r : uncovered) hits += __builtin_popcountll(r);
+        if (hits == 0) break;
+        if (ships.empty()) return false;
+
+        int pick = std::uniform_int_distribution<int>(0, hits - 1)(rng);
+        int hx = 0, hy = 0;
+        for (hy = 0; hy < n; ++hy) {
+            int c = __builtin_popcountll(uncovered[hy]);
+            if (pick < c) break;
+            pick -= c;
+        }
+        uint64_t r = uncovered[hy];
+        for (int i = 0; i < pick; ++i) r &= r - 1;
+        hx = __builtin_ctzll(r);
+
+        candidates.clear();
+        int prevLen = -1;
+        for (int len : ships) {
+            if (len == prevLen) continue;
+            prevLen = len;
+            for (int off = 0; off < len; ++off) {
+                Placement h{hx - off, hy, len, true};
+                if (ctx.fits(h, occ)) candidates.push_back(h);
+                if (len > 1) {
+                    Placement v{hx, hy - off, len, false};
+                    if (ctx.fits(v, occ)) candidates.push_back(v);
+                }
+            }
+        }
+        if (candidates.empty()) return false;
+
+        const Placement& p = candidates[std::uniform_int_distribution<size_t>(0, candidates.size() - 1)(rng)];
+        SampleContext::place(p, occ);
+        ships.erase(std::find(ships.begin(), ships.end(), p.len));
+        for (int y = 0; y < n; ++y) uncovered[y] &= ~occ[y];
+    }
+
+    for (int len : ships) {
+        const auto& list = ctx.placements.at(len);
+        if (list.empty()) return false;
+        std::uniform_int_distribution<size_t> dis(0, list.size() - 1);
+        bool placed = false;
+        for (int attempt = 0; attempt < 32 && !placed; ++attempt) {
+            const Placement& p = list[dis(rng)];
+            if (ctx.fits(p, occ)) {
+                SampleContext::place(p, occ);
+                placed = true;
+            }
+        }
+        if (!placed) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+MonteCarloAI::MonteCarloAI(const MonteCarloConfig& config)
+    : config(config), pool(std::make_unique<WorkStealingPool>(config.threads)) {}
+
+std::pair<int, int> MonteCarloAI::chooseShot(const BoardKnowledge& knowledge) {
+    using Clock = std::chrono::steady_clock;
+    const auto deadline = Clock::now() + std::chrono::milliseconds(config.timeBudgetMs);
+    const int n = knowledge.size;
+    const uint64_t decisionSeed = mix(config.seed ^ mix(decision++));
+
+    SampleContext ctx;
+    ctx.n = n;
+    ctx.free.resize(n);
+    ctx.hit = knowledge.hit;
+    ctx.known.resize(n);
+    for (int y = 0; y < n; ++y) {
+        ctx.free[y] = ~(knowledge.miss[y] | knowledge.sunk[y]) & rowMask(n);
+        ctx.known[y] = knowledge.miss[y] | knowledge.hit[y] | knowledge.sunk[y];
+    }
+    ctx.ships = knowledge.remainingShips;
+    std::sort(ctx.ships.begin(), ctx.ships.end(), std::greater<int>());
+    for (int len : ctx.ships) {
+        auto& list = ctx.placements[len];
+        if (!list.empty()) continue;
+        std::vector<uint64_t> none(n, 0);
+        for (int y = 0; y < n; ++y) {
+            for (int x = 0; x < n; ++x) {
+                Placement h{x, y, len, true};
+                if (ctx.fits(h, none)) list.push_back(h);
+                Placement v{x, y, len, false};
+                if (len > 1 && ctx.fits(v, none)) list.push_back(v);
+            }
+        }
+    }
+
+    // Свой накопитель у каждого потока пула, сливаются после завершения всех задач
+    const unsigned threads = pool->size();
+    std::vector<std::vector<uint64_t>> acc(threads, std::vector<uint64_t>(n * n, 0));
+    std::vector<size_t> accepted(threads, 0);
+
+    const size_t batch = std::max<size_t>(1, config.batchSize);
+    const size_t tasks = (config.maxSamples + batch - 1) / batch;
+    for (size_t t = 0; t < tasks; ++t) {
+        pool->submit([&, t]() {
+            auto expired = [&]() {
+                return (stopFlag && stopFlag->load(std::memory_order_relaxed)) ||
+                       (config.timeBudgetMs > 0 && Clock::now() >= deadline);
+            };
+            if (expired()) return;
+
+            // Отдельный поток случайных чисел на задачу: результат не зависит от того,
+            // какой поток её украл
+            std::mt19937_64 rng(mix(decisionSeed + t));
+            std::vector<uint64_t> occ;
+            std::vector<int> ships;
+            std::vector<Placement> candidates;
+            std::vector<uint64_t> local(n * n, 0);
+            size_t ok = 0;
+            const size_t quota = std::min(batch, config.maxSamples - t * batch);
+
+            for (size_t i = 0; i < quota; ++i) {
+                if ((i & 63) == 63 && expired()) break;
+                if (!sampleLayout(ctx, rng, occ, ships, candidates)) continue;
+                ok++;
+                for (int y = 0; y < n; ++y) {
+                    uint64_t r = occ[y] & ~ctx.known[y];
+                    while (r) {
+                        local[y * n + __builtin_ctzll(r)]++;
+                        r &= r - 1;
+                    }
+                }
+            }
+
+            int w = WorkStealingPool::workerIndex();
+            auto& dst = acc[w];
+            for (int c = 0; c < n * n; ++c) dst[c] += local[c];
+            accepted[w] += ok;
+        });
+    }
+    pool->wait();
+
+    frequencies.assign(n * n, 0);
+    samples = 0;
+    for (unsigned w = 0; w < threads; ++w) {
+        for (int c = 0; c < n * n; ++c) frequencies[c] += acc[w][c];
+        samples += accepted[w];
+    }
+
+    // Ни одной согласованной расстановки - выбор по тепловой карте
+    if (samples == 0) {
+        BattleShipAI fallback(static_cast<unsigned>(decisionSeed));
+        fallback.setEndgameConfig({0, 0, 0});
+        return fallback.chooseShot(knowledge);
+    }
+
+    std::pair<int, int> best(-1, -1);
+    uint64_t bestCount = 0;
+    for (int y = 0; y < n; ++y) {
+        for (int x = 0; x < n; ++x) {
+            if (!knowledge.canShoot(x, y)) continue;
+            uint64_t f = frequencies[y * n + x];
+            if (best.first < 0 || f > bestCount) {
+                best = {x, y};
+                bestCount = f;
+            }
+        }
+    }
+    return best;
+}
@@ -0,0 +1,49 @@
+// montecarloai.h
+#ifndef MONTECARLOAI_H
+#define MONTECARLOAI_H
+
+#include "boardknowledge.h"
+#include "workstealingpool.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+struct MonteCarloConfig {
+    unsigned threads = 0;          // 0 - по числу ядер
+    int timeBudgetMs = 50;         // ограничение времени на ход; 0 - без ограничения
+    size_t maxSamples = 200000;    // сколько расстановок разыграть самое большее
+    size_t batchSize = 256;        // расстановок в одной задаче пула
+    uint64_t seed = 0x5EAF1647;    // при одинаковом seed и без лимита времени ход повторяется
+};
+
+// Выбор выстрела по частотам: случайные расстановки оставшихся кораблей,
+// согласованные с известными промахами, попаданиями и потопленными кораблями,
+// разыгрываются параллельно, и выбирается клетка, чаще всего занятая кораблём.
+class MonteCarloAI {
+public:
+    explicit MonteCarloAI(const MonteCarloConfig& config = MonteCarloConfig());
+
+    std::pair<int, int> chooseShot(const BoardKnowledge& knowledge);
+
+    // Частота занятости клеток (y * size + x) и число принятых расстановок последнего хода
+    const std::vector<uint64_t>& lastFrequencies() const { return frequencies; }
+    size_t lastSampleCount() const { return samples; }
+
+    void setTimeBudget(int ms) { config.timeBudgetMs = ms; }
+    void reseed(uint64_t seed) { config.seed = seed; decision = 0; }
+    // Флаг отмены из другого потока: розыгрыш останавливается, ход выбирается по набранному
+    void setStopFlag(const std::atomic<bool> *flag) { stopFlag = flag; }
+
+private:
+    MonteCarloConfig config;
+    std::unique_ptr<WorkStealingPool> pool;
+    std::vector<uint64_t> frequencies;
+    size_t samples = 0;
+    uint64_t decision = 0;
+    const std::atomic<bool> *stopFlag = nullptr;
+};
+
+#endif // MONTECARLOAI_H
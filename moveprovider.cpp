@@ -0,0 +1,286 @@
+#include "moveprovider.h"
+#include "battleshipai.h"
+#include "montecarloai.h"
+#include "botprotocol.h"
+#include <QDebug>
+
+// Живёт в потоке провайдера и владеет движками: они не потокобезопасны
+// и используются только отсюда
+class EngineWorker : public QObject {
+    Q_OBJECT
+public:
+    explicit EngineWorker(EngineMoveProvider::Engine engine) : engine(engine) {}
+
+    void compute(quint64 request, const BoardKnowledge& snapshot, int timeBudgetMs,
+                 std::shared_ptr<std::atomic<bool>> stop) {
+        if (stop->load()) return;
+
+        std::pair<int, int> shot;
+        if (engine == EngineMoveProvider::MonteCarloEngine &&
+            openingBook && openingBook->nextShot(bookSection, snapshot, shot)) {
+            // Дебют из книги, Монте-Карло не нужен
+        } else if (engine == EngineMoveProvider::MonteCarloEngine) {
+            if (!monteCarlo) monteCarlo = std::make_unique<MonteCarloAI>();
+            monteCarlo->setTimeBudget(timeBudgetMs);
+            monteCarlo->setStopFlag(stop.get());
+            shot = monteCarlo->chooseShot(snapshot);
+            monteCarlo->setStopFlag(nullptr);
+        } else {
+            EndgameConfig config = heatMap.endgameConfig();
+            config.timeBudgetMs = timeBudgetMs;
+            heatMap.setEndgameConfig(config);
+            heatMap.setStopFlag(stop.get());
+            shot = heatMap.chooseShot(snapshot);
+            heatMap.setStopFlag(nullptr);
+        }
+
+        if (!stop->load()) emit computed(request, shot.first, shot.second);
+    }
+
+    void setOpeningBook(const OpeningBook *book, const BookSection *section) {
+        openingBook = book;
+        bookSection = section;
+        heatMap.setOpeningBook(book, section);
+    }
+
+signals:
+    void computed(quint64 request, int x, int y);
+
+private:
+    EngineMoveProvider::Engine engine;
+    const OpeningBook *openingBook = nullptr;
+    const BookSection *bookSection = nullptr;
+    BattleShipAI heatMap;
+    std::unique_ptr<MonteCarloAI> monteCarlo;
+};
+
+EngineMoveProvider::EngineMoveProvider(Engine engine, int timeBudgetMs, QObject *parent)
+    : MoveProvider(parent), worker(new EngineWorker(engine)), timeBudgetMs(timeBudgetMs)
+{
+    worker->moveToThread(&thread);
+    connect(&thread, &QThread::finished, worker, &QObject::deleteLater);
+    // Соединение между потоками - ответ ставится в очередь событий потока игры
+    connect(worker, &EngineWorker::computed, this, &EngineMoveProvider::onComputed,
+            Qt::QueuedConnection);
+    thread.setObjectName("AI engine");
+    thread.start();
+}
+
+EngineMoveProvider::~EngineMoveProvider() {
+    cancel();
+    thread.quit();
+    thread.wait();
+}
+
+void EngineMoveProvider::requestMove(const BoardKnowledge& snapshot) {
+    cancel();
+
+    quint64 request = ++currentRequest;
+    currentStop = std::make_shared<std::atomic<bool>>(false);
+    thinking = true;
+
+    // Снимок копируется в лямбду: игра может менять свои поля, пока ИИ думает
+    EngineWorker *w = worker;
+    auto stop = currentStop;
+    int budget = timeBudgetMs;
+    QMetaObject::invokeMethod(worker, [w, request, snapshot, budget, stop]() {
+        w->compute(request, snapshot, budget, stop);
+    }, Qt::QueuedConnection);
+}
+
+void EngineMoveProvider::setOpeningBook(const OpeningBook *book, const BookSection *section) {
+    // Через очередь потока движка: запросы, отправленные после, уже увидят книгу
+    EngineWorker *w = worker;
+    QMetaObject::invokeMethod(worker, [w, book, section]() {
+        w->setOpeningBook(book, section);
+    }, Qt::QueuedConnection);
+}
+
+void EngineMoveProvider::cancel() {
+    if (currentStop) currentStop->store(true);
+    currentStop.reset();
+    thinking = false;
+}
+
+void EngineMoveProvider::onComputed(quint64 request, int x, int y) {
+    // Ответ на отменённый или устаревший запрос
+    if (request != currentRequest || !thinking) return;
+
+    thinking = false;
+    currentStop.reset();
+    qDebug() << "AI move ready:" << x << y;
+    emit moveReady(x, y);
+}
+
+BotMoveProvider::BotMoveProvider(const QString& command, int moveTimeMs, QObject *parent)
+    : MoveProvider(parent), botName(command), moveTimeMs(moveTimeMs), rng(std::random_device{}())
+{
+    deadline.setSingleShot(true);
+    connect(&deadline, &QTimer::timeout, this, &BotMoveProvider::onDeadline);
+    placementDeadline.setSingleShot(true);
+    connect(&placementDeadline, &QTimer::timeout, this, &BotMoveProvider::onPlacementTimeout);
+    connect(&process, &QProcess::readyReadStandardOutput, this, &BotMoveProvider::onReadyRead);
+    connect(&process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &BotMoveProvider::onFinished);
+    connect(&process, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error) {
+        qDebug() << "Bot" << botName << "error:" << process.errorString();
+        // Незапустившийся процесс не присылает finished: расстановку не ждём до срока
+        if (error == QProcess::FailedToStart && placing) completePlacement(false, placementBase);
+    });
+
+    // stderr бота идёт в наш - туда боты пишут отладку
+    process.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    QStringList args = QProcess::splitCommand(command);
+    if (!args.isEmpty()) {
+        QString program = args.takeFirst();
+        process.start(program, args);
+    }
+    send("sbp\n");
+}
+
+BotMoveProvider::~BotMoveProvider() {
+    process.disconnect(this);
+    if (!isRunning()) return;
+    send("quit\n");
+    process.closeWriteChannel();
+    if (!process.waitForFinished(500)) {
+        process.kill();
+        process.waitForFinished(500);
+    }
+}
+
+void BotMoveProvider::send(const std::string& lines) {
+    if (isRunning()) process.write(lines.data(), qint64(lines.size()));
+}
+
+void BotMoveProvider::newGame(int size, int mines, const std::vector<int>& fleet) {
+    send(botproto::newGameCommand(size, mines, fleet) + '\n');
+}
+
+void BotMoveProvider::requestPlacement(const Grid& base, const std::vector<int>& fleet) {
+    placementBase = base;
+    placementFleet = fleet;
+    placing = true;
+    if (!isRunning()) {
+        // Ответ не раньше возврата из requestPlacement, как и у requestMove
+        QTimer::singleShot(0, this, [this]() { if (placing) completePlacement(false, placementBase); });
+        return;
+    }
+    send("place\n");
+    placementDeadline.start(botproto::HANDSHAKE_TIMEOUT_MS);
+}
+
+void BotMoveProvider::completePlacement(bool placed, const Grid& grid) {
+    placing = false;
+    placementDeadline.stop();
+    emit placementReady(placed, grid);
+}
+
+void BotMoveProvider::requestMove(const BoardKnowledge& snapshot) {
+    cancel();
+    current = snapshot;
+    thinking = true;
+    stopSent = false;
+    if (!isRunning()) {
+        // Ответ не раньше возврата из requestMove, как у встроенного ИИ
+        QTimer::singleShot(0, this, [this]() { if (thinking) fallbackMove(); });
+        return;
+    }
+    send(botproto::positionCommand(snapshot) + '\n' + botproto::goCommand(moveTimeMs) + '\n');
+    deadline.start(moveTimeMs + botproto::GRACE_MS);
+}
+
+void BotMoveProvider::cancel() {
+    if (!thinking) return;
+    thinking = false;
+    deadline.stop();
+    send("stop\n");
+    resync();
+}
+
+void BotMoveProvider::shotResult(int x, int y, const rules::ShotResult& result) {
+    send(botproto::resultCommand(x, y, result) + '\n');
+}
+
+void BotMoveProvider::resync() {
+    syncing = true;
+    send("isready\n");
+}
+
+void BotMoveProvider::onReadyRead() {
+    while (process.canReadLine()) handleLine(QString::fromUtf8(process.readLine()).trimmed());
+}
+
+void BotMoveProvider::handleLine(const QString& line) {
+    auto [cmd, args] = botproto::splitCommand(line.toStdString());
+    if (cmd == "id" && args.compare(0, 5, "name ") == 0) {
+        botName = QString::fromStdString(args.substr(5));
+        return;
+    }
+    if (syncing) {
+        // Всё до readyok - ответы на отменённые и просроченные запросы
+        if (cmd == "readyok") syncing = false;
+        return;
+    }
+    if (cmd == "placement" && placing) {
+        Grid grid = placementBase;
+        const bool placed = botproto::applyPlacement(args, placementFleet, grid);
+        if (!placed) qDebug() << "Bot" << botName << "illegal placement:" << line;
+        completePlacement(placed, placed ? grid : placementBase);
+        return;
+    }
+    if (cmd != "bestmove" || !thinking) return;
+
+    int x = -1, y = -1;
+    if (!botproto::parseBestMove(args, x, y) || x < 0 || y < 0 || x >= current.size || y >= current.size ||
+        !current.canShoot(x, y)) {
+        qDebug() << "Bot" << botName << "illegal move:" << line;
+        deadline.stop();
+        fallbackMove();
+        return;
+    }
+    thinking = false;
+    deadline.stop();
+    emit moveReady(x, y);
+}
+
+void BotMoveProvider::onDeadline() {
+    if (!thinking) return;
+    if (!stopSent) {
+        // Срок вышел: просим ответить сейчас и даём на это ещё немного времени
+        stopSent = true;
+        send("stop\n");
+        deadline.start(botproto::GRACE_MS);
+        return;
+    }
+    qDebug() << "Bot" << botName << "timed out, playing a random move";
+    resync();
+    fallbackMove();
+}
+
+void BotMoveProvider::onPlacementTimeout() {
+    if (!placing) return;
+    qDebug() << "Bot" << botName << "did not place the fleet in time";
+    resync();
+    completePlacement(false, placementBase);
+}
+
+void BotMoveProvider::onFinished() {
+    qDebug() << "Bot" << botName << "exited, random moves from now on";
+    deadline.stop();
+    if (placing) completePlacement(false, placementBase);
+    if (thinking) fallbackMove();
+}
+
+void BotMoveProvider::fallbackMove() {
+    std::vector<std::pair<int, int>> free;
+    for (int y = 0; y < current.size; ++y)
+        for (int x = 0; x < current.size; ++x)
+            if (current.canShoot(x, y)) free.emplace_back(x, y);
+    thinking = false;
+    if (free.empty()) return;
+    auto [x, y] = free[std::uniform_int_distribution<size_t>(0, free.size() - 1)(rng)];
+    emit moveReady(x, y);
+}
+
+#include "moveprovider.moc"
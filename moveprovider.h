@@ -0,0 +1,117 @@
+// moveprovider.h
+#ifndef MOVEPROVIDER_H
+#define MOVEPROVIDER_H
+
+#include "boardknowledge.h"
+#include "gamerules.h"
+#include "openingbook.h"
+#include <QObject>
+#include <QProcess>
+#include <QThread>
+#include <QTimer>
+#include <atomic>
+#include <memory>
+#include <random>
+
+// Источник ходов: игра отдаёт снимок позиции, ответ приходит сигналом moveReady
+// в потоке игры. Пока ход считается, поток GUI не блокируется.
+class MoveProvider : public QObject {
+    Q_OBJECT
+public:
+    explicit MoveProvider(QObject *parent = nullptr) : QObject(parent) {}
+
+    virtual void requestMove(const BoardKnowledge& snapshot) = 0;
+    // Отменяет текущий запрос; его результат уже не придёт
+    virtual void cancel() = 0;
+    virtual bool isThinking() const = 0;
+    // Исход хода, выданного этим провайдером; встроенному ИИ не нужен - он видит его в снимке
+    virtual void shotResult(int, int, const rules::ShotResult&) {}
+
+signals:
+    void moveReady(int x, int y);
+};
+
+class EngineWorker;
+
+// Встроенный ИИ (тепловая карта с точным эндшпилем или Монте-Карло) в отдельном потоке
+class EngineMoveProvider : public MoveProvider {
+    Q_OBJECT
+public:
+    enum Engine { HeatMapEngine, MonteCarloEngine };
+
+    explicit EngineMoveProvider(Engine engine, int timeBudgetMs, QObject *parent = nullptr);
+    ~EngineMoveProvider();
+
+    void requestMove(const BoardKnowledge& snapshot) override;
+    void cancel() override;
+    bool isThinking() const override { return thinking; }
+
+    // Книга должна жить дольше провайдера; применяется со следующего запроса
+    void setOpeningBook(const OpeningBook *book, const BookSection *section);
+
+private slots:
+    void onComputed(quint64 request, int x, int y);
+
+private:
+    QThread thread;
+    EngineWorker *worker;
+    int timeBudgetMs;
+    quint64 currentRequest = 0;
+    bool thinking = false;
+    std::shared_ptr<std::atomic<bool>> currentStop;
+};
+
+// Внешний бот (botprotocol.h) дочерним процессом. Срок хода отмеряет хост:
+// не ответил вовремя и на stop - ход берётся случайный, поздний ответ отбрасывается
+// синхронизацией через isready. Упавший бот тоже заменяется случайными ходами
+class BotMoveProvider : public MoveProvider {
+    Q_OBJECT
+public:
+    BotMoveProvider(const QString& command, int moveTimeMs, QObject *parent = nullptr);
+    ~BotMoveProvider();
+
+    void newGame(int size, int mines, const std::vector<int>& fleet);
+    // Расстановка флота на base (мины уже стоят); ответ - сигнал placementReady,
+    // не позже botproto::HANDSHAKE_TIMEOUT_MS. Поток GUI не ждёт бота
+    void requestPlacement(const Grid& base, const std::vector<int>& fleet);
+    bool isPlacing() const { return placing; }
+
+    void requestMove(const BoardKnowledge& snapshot) override;
+    void cancel() override;
+    bool isThinking() const override { return thinking; }
+    void shotResult(int x, int y, const rules::ShotResult& result) override;
+
+signals:
+    // placed == false: бот не ответил или расставил не по правилам, grid - исходное поле
+    void placementReady(bool placed, const Grid& grid);
+
+private slots:
+    void onReadyRead();
+    void onDeadline();
+    void onPlacementTimeout();
+    void onFinished();
+
+private:
+    QProcess process;
+    QTimer deadline;
+    QTimer placementDeadline;
+    QString botName;
+    int moveTimeMs;
+    bool thinking = false;
+    bool stopSent = false;
+    bool syncing = false;           // до readyok приходят ответы на отменённые запросы
+    BoardKnowledge current;
+    bool placing = false;
+    Grid placementBase;
+    std::vector<int> placementFleet;
+    std::mt19937 rng;
+
+    bool isRunning() const { return process.state() != QProcess::NotRunning; }
+    void send(const std::string& lines);
+    void handleLine(const QString& line);
+    void resync();
+    void fallbackMove();
+    void completePlacement(bool placed, const Grid& grid);
+};
+
+#endif // MOVEPROVIDER_H
@@ -0,0 +1,233 @@
+#include "openingbook.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+const char BOOK_MAGIC[8] = {'S', 'E', 'A', 'B', 'O', 'O', 'K', 0};
+const int MAX_BOOK_BOARD_SIZE = 12;
+
+uint64_t mix(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+size_t align8(size_t offset) {
+    return (offset + 7) & ~size_t(7);
+}
+
+} // namespace
+
+uint64_t OpeningBook::positionKey(const BoardKnowledge& knowledge) {
+    uint64_t h = mix(uint64_t(knowledge.size));
+    for (int y = 0; y < knowledge.size; ++y) {
+        h = mix(h ^ knowledge.miss[y]);
+        h = mix(h ^ (knowledge.hit[y] * 0xC2B2AE3D27D4EB4FULL));
+        h = mix(h ^ (knowledge.sunk[y] * 0x165667B19E3779F9ULL));
+    }
+    return h;
+}
+
+bool OpeningBook::attach(const void *data, size_t size) {
+    base = nullptr;
+    header = nullptr;
+
+    auto bytes = static_cast<const uint8_t *>(data);
+    if (!bytes || size < sizeof(BookHeader) || reinterpret_cast<uintptr_t>(bytes) % 8 != 0)
+        return false;
+
+    auto h = reinterpret_cast<const BookHeader *>(bytes);
+    if (std::memcmp(h->magic, BOOK_MAGIC, sizeof(BOOK_MAGIC)) != 0 ||
+        h->version != OPENING_BOOK_VERSION || h->fileSize != size)
+        return false;
+    if (sizeof(BookHeader) + uint64_t(h->sectionCount) * sizeof(BookSection) > size)
+        return false;
+
+    // Проверяем границы один раз, дальше поиск обращается к памяти без проверок
+    auto sections = reinterpret_cast<const BookSection *>(bytes + sizeof(BookHeader));
+    for (uint32_t i = 0; i < h->sectionCount; ++i) {
+        const BookSection& s = sections[i];
+        uint64_t cells = uint64_t(s.gridSize) * s.gridSize;
+        if (s.gridSize == 0 || s.gridSize > MAX_BOOK_BOARD_SIZE) return false;
+        if (s.occupancyOffset % 8 || s.occupancyOffset + cells * sizeof(uint16_t) > size) return false;
+        if (s.entriesOffset % 8 || s.entriesOffset + uint64_t(s.entryCount) * sizeof(BookEntry) > size)
+            return false;
+    }
+
+    base = bytes;
+    header = h;
+    return true;
+}
+
+const BookSection *OpeningBook::find(int gridSize, bool mines) const {
+    if (!header) return nullptr;
+    auto sections = reinterpret_cast<const BookSection *>(base + sizeof(BookHeader));
+    for (uint32_t i = 0; i < header->sectionCount; ++i) {
+        if (sections[i].gridSize == gridSize && bool(sections[i].mines) == mines) return &sections[i];
+    }
+    return nullptr;
+}
+
+const uint16_t *OpeningBook::occupancy(const BookSection *section) const {
+    return section ? reinterpret_cast<const uint16_t *>(base + section->occupancyOffset) : nullptr;
+}
+
+bool OpeningBook::nextShot(const BookSection *section, const BoardKnowledge& knowledge,
+                           std::pair<int, int>& shot) const {
+    if (!section || knowledge.size != section->gridSize) return false;
+
+    auto begin = reinterpret_cast<const BookEntry *>(base + section->entriesOffset);
+    auto end = begin + section->entryCount;
+    const uint64_t key = positionKey(knowledge);
+    auto it = std::lower_bound(begin, end, key,
+                               [](const BookEntry& e, uint64_t k) { return e.key < k; });
+    if (it == end || it->key != key || !knowledge.canShoot(it->x, it->y)) return false;
+
+    shot = {it->x, it->y};
+    return true;
+}
+
+void OpeningBookBuilder::addBoard(bool mines, const Grid& board) {
+    const int n = int(board.size());
+    if (n == 0 || n > MAX_BOOK_BOARD_SIZE) return;
+
+    Collection *target = nullptr;
+    for (auto& c : collections) {
+        if (c.gridSize == n && c.mines == mines) target = &c;
+    }
+    if (!target) {
+        collections.push_back({n, mines, {}});
+        target = &collections.back();
+    }
+
+    Board b{};
+    for (int x = 0; x < n; ++x) {
+        for (int y = 0; y < n; ++y) {
+            int i = y * n + x;
+            if (board[x][y] == Ship) b.ship[i >> 6] |= uint64_t(1) << (i & 63);
+            else if (board[x][y] == Mine) b.mine[i >> 6] |= uint64_t(1) << (i & 63);
+        }
+    }
+    target->boards.push_back(b);
+}
+
+size_t OpeningBookBuilder::boardCount() const {
+    size_t total = 0;
+    for (const auto& c : collections) total += c.boards.size();
+    return total;
+}
+
+// Жадная цепочка: в каждой позиции стреляем туда, где корабль стоял чаще всего
+// среди полей, согласованных с уже сделанными промахами. После попадания
+// дальше ведёт добивание ИИ, поэтому книга хранит только ветку промахов.
+std::vector<BookEntry> OpeningBookBuilder::buildOpening(const Collection& c) const {
+    const int n = c.gridSize;
+    const int cells = n * n;
+
+    std::vector<const Board *> alive;
+    for (const auto& b : c.boards) alive.push_back(&b);
+
+    BoardKnowledge knowledge;
+    knowledge.reset(n);
+    std::array<uint64_t, 3> tried{};
+    std::vector<uint32_t> counts(cells);
+    std::vector<BookEntry> entries;
+
+    for (int depth = 0; depth < maxDepth && alive.size() >= minSupport; ++depth) {
+        std::fill(counts.begin(), counts.end(), 0);
+        for (const Board *b : alive) {
+            for (int w = 0; w < 3; ++w) {
+                for (uint64_t bits = b->ship[w] & ~tried[w]; bits; bits &= bits - 1)
+                    counts[w * 64 + __builtin_ctzll(bits)]++;
+            }
+        }
+
+        int best = -1;
+        for (int i = 0; i < cells; ++i) {
+            if (!((tried[i >> 6] >> (i & 63)) & 1) && (best < 0 || counts[i] > counts[best])) best = i;
+        }
+        if (best < 0 || counts[best] == 0) break;
+
+        const int x = best % n, y = best / n;
+        entries.push_back({OpeningBook::positionKey(knowledge), uint8_t(x), uint8_t(y),
+                           uint16_t(uint64_t(counts[best]) * 65535 / alive.size()),
+                           uint32_t(alive.size())});
+
+        // Следующая позиция - обычный промах: ни корабля, ни мины в этой клетке
+        const uint64_t bit = uint64_t(1) << (best & 63);
+        tried[best >> 6] |= bit;
+        knowledge.miss[y] |= uint64_t(1) << x;
+        alive.erase(std::remove_if(alive.begin(), alive.end(), [&](const Board *b) {
+            return ((b->ship[best >> 6] | b->mine[best >> 6]) & bit) != 0;
+        }), alive.end());
+    }
+
+    std::sort(entries.begin(), entries.end(),
+              [](const BookEntry& a, const BookEntry& b) { return a.key < b.key; });
+    return entries;
+}
+
+bool OpeningBookBuilder::write(const std::string& path) const {
+    std::vector<const Collection *> used;
+    for (const auto& c : collections) {
+        if (!c.boards.empty()) used.push_back(&c);
+    }
+
+    size_t offset = align8(sizeof(BookHeader) + used.size() * sizeof(BookSection));
+    std::vector<BookSection> sections;
+    std::vector<std::vector<uint16_t>> occupancies;
+    std::vector<std::vector<BookEntry>> entries;
+
+    for (const Collection *c : used) {
+        const int cells = c->gridSize * c->gridSize;
+        std::vector<uint64_t> counts(cells, 0);
+        for (const auto& b : c->boards) {
+            for (int w = 0; w < 3; ++w) {
+                for (uint64_t bits = b.ship[w]; bits; bits &= bits - 1)
+                    counts[w * 64 + __builtin_ctzll(bits)]++;
+            }
+        }
+        std::vector<uint16_t> occupancy(cells);
+        for (int i = 0; i < cells; ++i) occupancy[i] = uint16_t(counts[i] * 65535 / c->boards.size());
+
+        BookSection s{};
+        s.gridSize = uint8_t(c->gridSize);
+        s.mines = c->mines ? 1 : 0;
+        s.games = c->boards.size();
+        s.occupancyOffset = offset;
+        offset = align8(offset + cells * sizeof(uint16_t));
+
+        entries.push_back(buildOpening(*c));
+        s.entryCount = uint32_t(entries.back().size());
+        s.entriesOffset = offset;
+        offset += entries.back().size() * sizeof(BookEntry);
+
+        sections.push_back(s);
+        occupancies.push_back(std::move(occupancy));
+    }
+
+    std::vector<uint8_t> buffer(offset, 0);
+    BookHeader header{};
+    std::memcpy(header.magic, BOOK_MAGIC, sizeof(BOOK_MAGIC));
+    header.version = OPENING_BOOK_VERSION;
+    header.sectionCount = uint32_t(sections.size());
+    header.fileSize = offset;
+    std::memcpy(buffer.data(), &header, sizeof(header));
+    for (size_t i = 0; i < sections.size(); ++i) {
+        std::memcpy(buffer.data() + sizeof(BookHeader) + i * sizeof(BookSection),
+                    &sections[i], sizeof(BookSection));
+        std::memcpy(buffer.data() + sections[i].occupancyOffset, occupancies[i].data(),
+                    occupancies[i].size() * sizeof(uint16_t));
+        if (!entries[i].empty()) {
+            std::memcpy(buffer.data() + sections[i].entriesOffset, entries[i].data(),
+                        entries[i].size() * sizeof(BookEntry));
+        }
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char *>(buffer.data()), std::streamsize(buffer.size()));
+    return bool(out);
+}
@@ -0,0 +1,103 @@
+// openingbook.h
+#ifndef OPENINGBOOK_H
+#define OPENINGBOOK_H
+
+#include "boardknowledge.h"
+#include "gametypes.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Формат файла дебютной книги (little-endian, все смещения кратны 8):
+//   BookHeader, затем sectionCount записей BookSection,
+//   затем данные разделов: занятость клеток (uint16 на клетку, y * size + x)
+//   и отсортированные по ключу BookEntry.
+// Раздел - пара (GameSize, режим мин). Файл читается прямо из отображённой
+// памяти, без разбора и копирования.
+const uint32_t OPENING_BOOK_VERSION = 1;
+
+struct BookHeader {
+    char magic[8];           // "SEABOOK"
+    uint32_t version;
+    uint32_t sectionCount;
+    uint64_t fileSize;
+};
+
+struct BookSection {
+    uint8_t gridSize;
+    uint8_t mines;
+    uint16_t reserved;
+    uint32_t entryCount;
+    uint64_t games;              // по скольким полям собрана статистика
+    uint64_t occupancyOffset;
+    uint64_t entriesOffset;
+};
+
+// Позиция дебюта (все выстрелы - промахи) и лучший следующий выстрел в ней
+struct BookEntry {
+    uint64_t key;                // OpeningBook::positionKey
+    uint8_t x, y;
+    uint16_t hitRate;            // доля полей с кораблём в этой клетке, 65535 = 100%
+    uint32_t support;            // сколько полей согласовано с позицией
+};
+
+static_assert(sizeof(BookHeader) == 24, "book header layout");
+static_assert(sizeof(BookSection) == 32, "book section layout");
+static_assert(sizeof(BookEntry) == 16, "book entry layout");
+
+// Только чтение уже загруженных данных: объект не меняется после attach,
+// поэтому поиск из любых потоков не требует блокировок.
+class OpeningBook {
+public:
+    // Проверяет заголовок и границы разделов; данные не копируются и должны жить дольше книги
+    bool attach(const void *data, size_t size);
+    bool isLoaded() const { return header != nullptr; }
+
+    const BookSection *find(int gridSize, bool mines) const;
+    // Вероятность корабля в клетке, 65535 = 100%
+    const uint16_t *occupancy(const BookSection *section) const;
+    // Выстрел из книги для позиции; false, если позиции нет в книге
+    bool nextShot(const BookSection *section, const BoardKnowledge& knowledge,
+                  std::pair<int, int>& shot) const;
+
+    static uint64_t positionKey(const BoardKnowledge& knowledge);
+
+private:
+    const uint8_t *base = nullptr;
+    const BookHeader *header = nullptr;
+};
+
+// Офлайн-сборка книги по начальным полям сыгранных партий
+class OpeningBookBuilder {
+public:
+    explicit OpeningBookBuilder(int maxDepth = 12, uint32_t minSupport = 200)
+        : maxDepth(maxDepth), minSupport(minSupport) {}
+
+    // Поле защищающейся стороны до первого выстрела (корабли и мины)
+    void addBoard(bool mines, const Grid& board);
+    size_t boardCount() const;
+
+    bool write(const std::string& path) const;
+
+private:
+    struct Board {
+        std::array<uint64_t, 3> ship;  // бит y * size + x, поле до 12x12
+        std::array<uint64_t, 3> mine;
+    };
+    struct Collection {
+        int gridSize;
+        bool mines;
+        std::vector<Board> boards;
+    };
+
+    int maxDepth;
+    uint32_t minSupport;
+    std::vector<Collection> collections;
+
+    std::vector<BookEntry> buildOpening(const Collection& c) const;
+};
+
+#endif // OPENINGBOOK_H
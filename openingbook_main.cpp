@@ -0,0 +1,187 @@
+// Сборка дебютной книги по начальным полям партий:
+//   sea_book --out opening.book --games 200000 --placement edges,classic
+//   sea_book --archive games.sea --out opening.book
+//   sea_book --verify opening.book
+#include "openingbook.h"
+#include "gamerecord.h"
+#include "gamerules.h"
+#include "selfplay.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+namespace {
+
+void printUsage() {
+    std::printf("usage: sea_book [--out file] [--games N] [--placement name[,name...]] [--sizes 8,10,12]\n"
+                "                [--mines N] [--depth N] [--min-support N] [--seed N]\n"
+                "       sea_book --archive games.sea [--out file] [--depth N] [--min-support N]\n"
+                "       sea_book --verify file\n");
+}
+
+std::vector<std::string> splitList(const std::string& value) {
+    std::vector<std::string> items;
+    std::stringstream stream(value);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+// Файл целиком в память, выровненную на 8 байт
+bool readFile(const std::string& path, std::vector<uint64_t>& data, size_t& size) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) {
+        std::fprintf(stderr, "cannot open %s\n", path.c_str());
+        return false;
+    }
+    size = size_t(in.tellg());
+    data.assign((size + 7) / 8, 0);
+    in.seekg(0);
+    in.read(reinterpret_cast<char *>(data.data()), std::streamsize(size));
+    return bool(in);
+}
+
+int verify(const std::string& path) {
+    std::vector<uint64_t> data;
+    size_t size = 0;
+    if (!readFile(path, data, size)) return 1;
+
+    OpeningBook book;
+    if (!book.attach(data.data(), size)) {
+        std::fprintf(stderr, "%s: not a valid opening book\n", path.c_str());
+        return 1;
+    }
+
+    for (int n : {8, 10, 12}) {
+        for (bool mines : {false, true}) {
+            const BookSection *s = book.find(n, mines);
+            if (!s) continue;
+            std::printf("%dx%d%s: %llu boards, %u opening positions\n", n, n, mines ? " with mines" : "",
+                        (unsigned long long)s->games, s->entryCount);
+
+            const uint16_t *occupancy = book.occupancy(s);
+            for (int y = 0; y < n; ++y) {
+                std::printf("   ");
+                for (int x = 0; x < n; ++x) std::printf(" %3d", occupancy[y * n + x] * 100 / 65535);
+                std::printf("\n");
+            }
+
+            // Цепочка книги при одних промахах
+            BoardKnowledge k;
+            k.reset(n);
+            std::pair<int, int> shot;
+            std::printf("    opening:");
+            while (book.nextShot(s, k, shot)) {
+                std::printf(" %c%d", 'A' + shot.first, shot.second + 1);
+                k.miss[shot.second] |= uint64_t(1) << shot.first;
+            }
+            std::printf("\n");
+        }
+    }
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    std::string out = "opening.book";
+    size_t games = 100000;
+    std::vector<std::string> placements = {"classic"};
+    std::vector<std::string> sizes = {"8", "10", "12"};
+    int minesCount = 2;
+    int depth = 12;
+    uint32_t minSupport = 200;
+    uint64_t seed = 1;
+    std::string archivePath;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || i + 1 >= argc) {
+            printUsage();
+            return arg == "--help" ? 0 : 1;
+        }
+        std::string value = argv[++i];
+        if (arg == "--verify") return verify(value);
+        else if (arg == "--out") out = value;
+        else if (arg == "--archive") archivePath = value;
+        else if (arg == "--games") games = std::strtoull(value.c_str(), nullptr, 10);
+        else if (arg == "--placement") placements = splitList(value);
+        else if (arg == "--sizes") sizes = splitList(value);
+        else if (arg == "--mines") minesCount = std::atoi(value.c_str());
+        else if (arg == "--depth") depth = std::atoi(value.c_str());
+        else if (arg == "--min-support") minSupport = uint32_t(std::strtoul(value.c_str(), nullptr, 10));
+        else if (arg == "--seed") seed = std::strtoull(value.c_str(), nullptr, 10);
+        else {
+            std::fprintf(stderr, "bad argument: %s %s\n", arg.c_str(), value.c_str());
+            printUsage();
+            return 1;
+        }
+    }
+
+    OpeningBookBuilder builder(depth, minSupport);
+
+    // Записанные партии: берём поля, известные полностью
+    if (!archivePath.empty()) {
+        std::vector<uint64_t> data;
+        size_t size = 0;
+        GameArchive archive;
+        if (!readFile(archivePath, data, size) || !archive.attach(data.data(), size)) {
+            std::fprintf(stderr, "%s: not a game archive\n", archivePath.c_str());
+            return 1;
+        }
+        for (size_t g = 0; g < archive.gameCount(); ++g) {
+            RecordedGame game = archive.game(g);
+            for (int side = 0; side < 2; ++side) {
+                if (!game.partial(side)) builder.addBoard(game.mines(), game.initialBoard(side));
+            }
+        }
+        if (!builder.write(out)) {
+            std::fprintf(stderr, "cannot write %s\n", out.c_str());
+            return 1;
+        }
+        std::printf("%zu games, %zu boards -> %s\n", archive.gameCount(), builder.boardCount(), out.c_str());
+        return 0;
+    }
+
+    std::vector<std::unique_ptr<PlacementStrategy>> strategies;
+    for (const auto& name : placements) {
+        strategies.push_back(makePlacementStrategy(name));
+        if (!strategies.back()) {
+            std::fprintf(stderr, "unknown placement: %s\n", name.c_str());
+            return 1;
+        }
+    }
+
+    // Начальные поля раскладываются так же, как в GameSimulator: сначала мины, потом флот
+    for (const auto& sizeName : sizes) {
+        const int n = std::atoi(sizeName.c_str());
+        if (n != 8 && n != 10 && n != 12) {
+            std::fprintf(stderr, "size must be 8, 10 or 12\n");
+            return 1;
+        }
+        const std::vector<int> fleet = rules::shipSizes(rules::fleetFor(n));
+        for (bool mines : {false, true}) {
+            if (mines && minesCount <= 0) continue;
+            for (size_t g = 0; g < games; ++g) {
+                uint64_t s = gameSeed(seed, g * 2 + (mines ? 1 : 0));
+                std::seed_seq seq{uint32_t(s), uint32_t(s >> 32), uint32_t(n)};
+                std::mt19937 rng(seq);
+                Grid board(n, std::vector<Cell>(n, Empty));
+                if (mines) rules::placeMines(board, minesCount, rng);
+                strategies[g % strategies.size()]->place(board, fleet, rng);
+                builder.addBoard(mines, board);
+            }
+        }
+    }
+
+    if (!builder.write(out)) {
+        std::fprintf(stderr, "cannot write %s\n", out.c_str());
+        return 1;
+    }
+    std::printf("%zu boards -> %s\n", builder.boardCount(), out.c_str());
+    return 0;
+}
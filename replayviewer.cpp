@@ -0,0 +1,130 @@
+#include "replayviewer.h"
+#include "battleshipgame.h"
+#include <QDateTime>
+#include <QGraphicsRectItem>
+#include <QGraphicsTextItem>
+#include <QHBoxLayout>
+#include <QPushButton>
+#include <QVBoxLayout>
+
+namespace {
+const int REPLAY_CELL_SIZE = 22;
+}
+
+ReplayViewer::ReplayViewer(const QString& archivePath, QWidget *parent)
+    : QDialog(parent), file(archivePath)
+{
+    setWindowTitle("Записи партий");
+
+    gameList = new QListWidget(this);
+    gameList->setMinimumWidth(260);
+    moveSlider = new QSlider(Qt::Horizontal, this);
+    moveLabel = new QLabel(this);
+    scene = new QGraphicsScene(this);
+    view = new QGraphicsView(scene, this);
+    view->setBackgroundBrush(QBrush(Qt::black));
+    view->setMinimumSize(REPLAY_CELL_SIZE * 12 * 2 + 120, REPLAY_CELL_SIZE * 12 + 80);
+
+    QPushButton *prevButton = new QPushButton("<", this);
+    QPushButton *nextButton = new QPushButton(">", this);
+    connect(prevButton, &QPushButton::clicked, [this]() { moveSlider->setValue(moveSlider->value() - 1); });
+    connect(nextButton, &QPushButton::clicked, [this]() { moveSlider->setValue(moveSlider->value() + 1); });
+
+    QHBoxLayout *controls = new QHBoxLayout;
+    controls->addWidget(prevButton);
+    controls->addWidget(moveSlider);
+    controls->addWidget(nextButton);
+    controls->addWidget(moveLabel);
+
+    QVBoxLayout *right = new QVBoxLayout;
+    right->addWidget(view);
+    right->addLayout(controls);
+
+    QHBoxLayout *layout = new QHBoxLayout(this);
+    layout->addWidget(gameList);
+    layout->addLayout(right);
+
+    connect(gameList, &QListWidget::currentRowChanged, this, &ReplayViewer::onGameSelected);
+    connect(moveSlider, &QSlider::valueChanged, this, &ReplayViewer::onMoveChanged);
+
+    // Архив не читается целиком: список строится по заголовкам записей в отображённой памяти
+    uchar *data = nullptr;
+    if (file.open(QIODevice::ReadOnly) && file.size() > 0) data = file.map(0, file.size());
+    if (!data || !archive.attach(data, size_t(file.size()))) {
+        moveLabel->setText("Записанных партий нет");
+        moveSlider->setEnabled(false);
+        return;
+    }
+
+    for (size_t i = 0; i < archive.gameCount(); ++i) {
+        RecordedGame g = archive.game(i);
+        QString result = g.winner() == 0 ? "победа" : g.winner() == 1 ? "поражение" : "не доиграна";
+        gameList->addItem(QString("%1  %2x%2%3  %4")
+                              .arg(QDateTime::fromSecsSinceEpoch(g.startTime()).toString("dd.MM.yyyy hh:mm"))
+                              .arg(g.gridSize())
+                              .arg(g.mines() ? ", мины" : "")
+                              .arg(result));
+    }
+    if (gameList->count() > 0) gameList->setCurrentRow(gameList->count() - 1);
+}
+
+void ReplayViewer::onGameSelected(int row) {
+    if (row < 0 || size_t(row) >= archive.gameCount()) return;
+    current = archive.game(size_t(row));
+    hasGame = true;
+    moveSlider->setRange(0, current.shotCount());
+    // Открываем сразу конец партии; valueChanged может не прийти, если значение то же
+    moveSlider->setValue(current.shotCount());
+    onMoveChanged(moveSlider->value());
+}
+
+void ReplayViewer::onMoveChanged(int move) {
+    if (!hasGame) return;
+
+    Grid boards[2];
+    current.boardsAt(move, boards);
+
+    int lastX = -1, lastY = -1, lastPlayer = -1;
+    if (move > 0) {
+        rules::ShotEvent last = current.shot(move - 1);
+        lastX = last.x;
+        lastY = last.y;
+        lastPlayer = last.player;
+    }
+
+    scene->clear();
+    const int width = current.gridSize() * REPLAY_CELL_SIZE;
+    drawBoard(boards[0], 30, "Игрок", lastPlayer == 1 ? lastX : -1, lastY);
+    drawBoard(boards[1], 60 + width, current.partial(1) ? "Противник (известное)" : "Противник",
+              lastPlayer == 0 ? lastX : -1, lastY);
+    moveLabel->setText(QString("Выстрел %1 из %2").arg(move).arg(current.shotCount()));
+}
+
+void ReplayViewer::drawBoard(const Grid& board, int offsetX, const QString& label, int lastX, int lastY) {
+    const int n = int(board.size());
+    const int offsetY = 40;
+
+    QGraphicsTextItem *title = new QGraphicsTextItem(label);
+    title->setFont(QFont("Arial", 12, QFont::Bold));
+    title->setDefaultTextColor(label == "Игрок" ? COLOR_PLAYER_LABEL : COLOR_AI_LABEL);
+    title->setPos(offsetX, offsetY - 30);
+    scene->addItem(title);
+
+    for (int x = 0; x < n; ++x) {
+        for (int y = 0; y < n; ++y) {
+            QGraphicsRectItem *cell = new QGraphicsRectItem(0, 0, REPLAY_CELL_SIZE - 2, REPLAY_CELL_SIZE - 2);
+            cell->setPos(offsetX + x * REPLAY_CELL_SIZE, offsetY + y * REPLAY_CELL_SIZE);
+            cell->setPen(x == lastX && y == lastY ? QPen(COLOR_TITLE, 2) : QPen(Qt::NoPen));
+
+            // В записи корабли обеих сторон открыты
+            switch (board[x][y]) {
+            case Ship: cell->setBrush(QBrush(COLOR_SHIP)); break;
+            case Hit: cell->setBrush(QBrush(COLOR_HIT)); break;
+            case Miss: cell->setBrush(QBrush(COLOR_MISS)); break;
+            case Mine: cell->setBrush(QBrush(COLOR_MINE)); break;
+            default: cell->setBrush(QBrush(QColor(10, 30, 80))); break;
+            }
+            scene->addItem(cell);
+        }
+    }
+}
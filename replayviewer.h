@@ -0,0 +1,40 @@
+// replayviewer.h
+#ifndef REPLAYVIEWER_H
+#define REPLAYVIEWER_H
+
+#include "gamerecord.h"
+#include <QDialog>
+#include <QFile>
+#include <QGraphicsScene>
+#include <QGraphicsView>
+#include <QLabel>
+#include <QListWidget>
+#include <QSlider>
+
+// Просмотр записанных партий: архив отображается в память, переход к любому
+// выстрелу - через ближайший ключевой кадр, без проигрывания партии с начала
+class ReplayViewer : public QDialog {
+    Q_OBJECT
+public:
+    explicit ReplayViewer(const QString& archivePath, QWidget *parent = nullptr);
+
+private slots:
+    void onGameSelected(int row);
+    void onMoveChanged(int move);
+
+private:
+    QFile file;
+    GameArchive archive;
+    RecordedGame current;
+    bool hasGame = false;
+
+    QListWidget *gameList;
+    QSlider *moveSlider;
+    QLabel *moveLabel;
+    QGraphicsScene *scene;
+    QGraphicsView *view;
+
+    void drawBoard(const Grid& board, int offsetX, const QString& label, int lastX, int lastY);
+};
+
+#endif // REPLAYVIEWER_H
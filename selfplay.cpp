@@ -0,0 +1,451 @@
+#include "selfplay.h"
+#include "battleshipai.h"
+#include "botengine.h"
+#include "gamerecord.h"
+#include "montecarloai.h"
+#include "workstealingpool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+uint64_t mix(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+class ClassicPlacement : public PlacementStrategy {
+public:
+    void place(Grid& grid, const std::vector<int>& sizes, std::mt19937& rng) override {
+        rules::placeFleetRandomly(grid, sizes, rng);
+    }
+};
+
+// Корабли могут касаться друг друга - правила это разрешают
+class TouchingPlacement : public PlacementStrategy {
+public:
+    void place(Grid& grid, const std::vector<int>& sizes, std::mt19937& rng) override {
+        std::uniform_int_distribution<> dis(0, int(grid.size()) - 1);
+        std::bernoulli_distribution orientation(0.5);
+        for (int size : sizes) {
+            for (;;) {
+                int x = dis(rng), y = dis(rng);
+                bool h = orientation(rng);
+                if (rules::canPlace(grid, x, y, size, h)) {
+                    rules::placeShip(grid, x, y, size, h);
+                    break;
+                }
+            }
+        }
+    }
+};
+
+// Типичная привычка людей - прижимать корабли к краю поля
+class EdgePlacement : public PlacementStrategy {
+public:
+    void place(Grid& grid, const std::vector<int>& sizes, std::mt19937& rng) override {
+        const int n = int(grid.size());
+        std::uniform_int_distribution<> dis(0, n - 1);
+        std::bernoulli_distribution orientation(0.5);
+        std::bernoulli_distribution inland(0.3);
+        for (int size : sizes) {
+            for (int attempt = 0; ; ++attempt) {
+                int x = dis(rng), y = dis(rng);
+                bool h = orientation(rng);
+                bool edge = h ? (y == 0 || y == n - 1 || x == 0 || x + size == n)
+                              : (x == 0 || x == n - 1 || y == 0 || y + size == n);
+                if (!edge && attempt < 200 && !inland(rng)) continue;
+                if (rules::canPlace(grid, x, y, size, h) &&
+                    (attempt > 1000 || rules::isSurroundingClear(grid, x, y, size, h))) {
+                    rules::placeShip(grid, x, y, size, h);
+                    break;
+                }
+            }
+        }
+    }
+};
+
+// Случайные выстрелы, после попадания - по соседним клеткам
+class RandomShooter : public ShootingStrategy {
+public:
+    void newGame(const MatchRules&, unsigned seed) override { rng.seed(seed); }
+
+    std::pair<int, int> chooseShot(const BoardKnowledge& k) override {
+        candidates.clear();
+        for (int y = 0; y < k.size; ++y) {
+            for (int x = 0; x < k.size; ++x) {
+                if (!((k.hit[y] >> x) & 1)) continue;
+                const int d[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+                for (auto& v : d) {
+                    int nx = x + v[0], ny = y + v[1];
+                    if (nx >= 0 && ny >= 0 && nx < k.size && ny < k.size && k.canShoot(nx, ny))
+                        candidates.emplace_back(nx, ny);
+                }
+            }
+        }
+        if (candidates.empty()) {
+            for (int y = 0; y < k.size; ++y)
+                for (int x = 0; x < k.size; ++x)
+                    if (k.canShoot(x, y)) candidates.emplace_back(x, y);
+        }
+        if (candidates.empty()) return {-1, -1};
+        return candidates[std::uniform_int_distribution<size_t>(0, candidates.size() - 1)(rng)];
+    }
+
+private:
+    std::mt19937 rng;
+    std::vector<std::pair<int, int>> candidates;
+};
+
+class HeatMapShooter : public ShootingStrategy {
+public:
+    explicit HeatMapShooter(bool exactEndgame) {
+        EndgameConfig config;
+        if (!exactEndgame) config.layoutThreshold = 0;
+        ai.setEndgameConfig(config);
+    }
+    void newGame(const MatchRules&, unsigned seed) override { ai.reseed(seed); }
+    std::pair<int, int> chooseShot(const BoardKnowledge& k) override { return ai.chooseShot(k); }
+
+private:
+    BattleShipAI ai;
+};
+
+// Монте-Карло в один поток: параллельны сами партии
+class MonteCarloShooter : public ShootingStrategy {
+public:
+    MonteCarloShooter() : ai(config()) {}
+    void newGame(const MatchRules&, unsigned seed) override { ai.reseed(seed); }
+    std::pair<int, int> chooseShot(const BoardKnowledge& k) override { return ai.chooseShot(k); }
+
+private:
+    static MonteCarloConfig config() {
+        MonteCarloConfig c;
+        c.threads = 1;
+        c.timeBudgetMs = 0;
+        c.maxSamples = 2000;
+        return c;
+    }
+    MonteCarloAI ai;
+};
+
+// Время на ход внешнего бота, если в имени стратегии не указано своё
+const int BOT_MOVETIME_MS = 100;
+
+// "bot=команда[@мс]"
+bool parseBotName(const std::string& name, std::string& command, int& moveTimeMs) {
+    if (name.compare(0, 4, "bot=") != 0 || name.size() == 4) return false;
+    command = name.substr(4);
+    moveTimeMs = BOT_MOVETIME_MS;
+    size_t at = command.rfind('@');
+    if (at != std::string::npos && at + 1 < command.size() &&
+        command.find_first_not_of("0123456789", at + 1) == std::string::npos) {
+        moveTimeMs = std::max(1, std::atoi(command.c_str() + at + 1));
+        command.resize(at);
+    }
+    return !command.empty();
+}
+
+// Процесс бота запускается при первой партии, не при создании: стратегии создаются
+// и для проверки имён. Упавший бот перезапускается со следующей партии
+class BotPlacement : public PlacementStrategy {
+public:
+    explicit BotPlacement(const std::string& command) : engine(command) {}
+
+    void place(Grid& grid, const std::vector<int>& sizes, std::mt19937& rng) override {
+        int mines = 0;
+        for (const auto& column : grid) mines += int(std::count(column.begin(), column.end(), Mine));
+        if (engine.newGame(int(grid.size()), mines, sizes) && engine.place(grid, sizes)) return;
+        if (!reported) {
+            std::fprintf(stderr, "bot placement '%s': %s, placing randomly\n", engine.name().c_str(),
+                         engine.error().c_str());
+            reported = true;
+        }
+        fallback.place(grid, sizes, rng);
+    }
+
+private:
+    BotEngine engine;
+    ClassicPlacement fallback;
+    bool reported = false;
+};
+
+class BotShooter : public ShootingStrategy {
+public:
+    BotShooter(const std::string& command, int moveTimeMs) : engine(command), moveTimeMs(moveTimeMs) {}
+
+    void newGame(const MatchRules& match, unsigned seed) override {
+        fallback.newGame(match, seed);
+        if (!engine.newGame(match.gridSize, match.minesEnabled ? match.minesCount : 0,
+                            rules::shipSizes(rules::fleetFor(match.gridSize))))
+            report();
+    }
+
+    std::pair<int, int> chooseShot(const BoardKnowledge& k) override {
+        // Правила соблюдает хост: просроченный, вне поля или в открытую клетку - запасной ход
+        std::pair<int, int> shot;
+        if (engine.isRunning() && engine.chooseShot(k, moveTimeMs, shot) &&
+            shot.first >= 0 && shot.second >= 0 && shot.first < k.size && shot.second < k.size &&
+            k.canShoot(shot.first, shot.second))
+            return shot;
+        report();
+        return fallback.chooseShot(k);
+    }
+
+    void shotResult(int x, int y, const rules::ShotResult& result) override {
+        if (engine.isRunning()) engine.notifyResult(x, y, result);
+    }
+
+private:
+    BotEngine engine;
+    int moveTimeMs;
+    RandomShooter fallback;
+    bool reported = false;
+
+    void report() {
+        if (reported) return;
+        std::fprintf(stderr, "bot '%s': %s, using random shots instead\n", engine.name().c_str(),
+                     engine.error().empty() ? "illegal move" : engine.error().c_str());
+        reported = true;
+    }
+};
+
+} // namespace
+
+std::unique_ptr<PlacementStrategy> makePlacementStrategy(const std::string& name) {
+    std::string command;
+    int moveTimeMs;
+    if (name == "classic") return std::make_unique<ClassicPlacement>();
+    if (name == "touching") return std::make_unique<TouchingPlacement>();
+    if (name == "edges") return std::make_unique<EdgePlacement>();
+    if (parseBotName(name, command, moveTimeMs)) return std::make_unique<BotPlacement>(command);
+    return nullptr;
+}
+
+std::unique_ptr<ShootingStrategy> makeShootingStrategy(const std::string& name) {
+    std::string command;
+    int moveTimeMs;
+    if (name == "random") return std::make_unique<RandomShooter>();
+    if (name == "heatmap") return std::make_unique<HeatMapShooter>(false);
+    if (name == "exact") return std::make_unique<HeatMapShooter>(true);
+    if (name == "montecarlo") return std::make_unique<MonteCarloShooter>();
+    if (parseBotName(name, command, moveTimeMs)) return std::make_unique<BotShooter>(command, moveTimeMs);
+    return nullptr;
+}
+
+std::vector<std::string> placementStrategyNames() {
+    return {"classic", "touching", "edges"};
+}
+
+std::vector<std::string> shootingStrategyNames() {
+    return {"random", "heatmap", "exact", "montecarlo"};
+}
+
+uint64_t gameSeed(uint64_t seed, uint64_t index) {
+    return mix(seed ^ mix(index));
+}
+
+GameSimulator::GameSimulator(const MatchRules& rules, const PlayerSpec& a, const PlayerSpec& b)
+    : matchRules(rules), sizes(rules::shipSizes(rules::fleetFor(rules.gridSize)))
+{
+    placement[0] = makePlacementStrategy(a.placement);
+    placement[1] = makePlacementStrategy(b.placement);
+    shooting[0] = makeShootingStrategy(a.shooting);
+    shooting[1] = makeShootingStrategy(b.shooting);
+}
+
+GameResult GameSimulator::play(uint64_t seed, int firstPlayer, bool record) {
+    const int n = matchRules.gridSize;
+    GameResult result;
+    result.firstPlayer = firstPlayer;
+
+    std::seed_seq seq{uint32_t(seed), uint32_t(seed >> 32)};
+    std::mt19937 rng(seq);
+
+    Grid boards[2];
+    BoardKnowledge knowledge[2];      // что сторона знает о поле соперника
+    std::vector<int> remaining[2];    // сколько кораблей каждой длины ещё на плаву
+    int shipsLeft[2];
+
+    for (int s = 0; s < 2; ++s) {
+        boards[s].assign(n, std::vector<Cell>(n, Empty));
+        if (matchRules.minesEnabled) rules::placeMines(boards[s], matchRules.minesCount, rng);
+        placement[s]->place(boards[s], sizes, rng);
+        if (record) result.boards[s] = boards[s];
+
+        knowledge[s].reset(n);
+        knowledge[s].remainingShips = sizes;
+        remaining[s].assign(n + 1, 0);
+        for (int len : sizes) remaining[s][len]++;
+        shipsLeft[s] = int(sizes.size());
+        shooting[s]->newGame(matchRules, unsigned(rng()));
+    }
+
+    // Защита от зацикливания: сливающиеся корабли могут так и не засчитаться потопленными
+    const int shotLimit = 4 * n * n;
+    int turn = firstPlayer;
+
+    // Исход выстрела стороны a по полю d переносится в её знание о поле соперника
+    auto apply = [&](int a, int d, int x, int y, const rules::ShotResult& shot) {
+        BoardKnowledge& k = knowledge[a];
+        switch (shot.kind) {
+        case rules::ShotResult::Hit:
+            k.hit[y] |= uint64_t(1) << x;
+            break;
+        case rules::ShotResult::MineHit: {
+            // Столько же, сколько в сетевом ответе MINE_HIT: маска подбитых взрывом соседей,
+            // остальная область 3x3 вместе с клеткой мины - промахи
+            const int mask = rules::mineBlastMask(x, y, shot);
+            for (int dx = -1; dx <= 1; ++dx) {
+                for (int dy = -1; dy <= 1; ++dy) {
+                    int nx = x + dx, ny = y + dy;
+                    if (!rules::isInside(boards[d], nx, ny) || k.isKnown(nx, ny)) continue;
+                    bool ship = (dx || dy) && (mask & (1 << rules::mineBlastBit(dx, dy)));
+                    (ship ? k.hit : k.miss)[ny] |= uint64_t(1) << nx;
+                }
+            }
+            break;
+        }
+        case rules::ShotResult::Miss:
+        case rules::ShotResult::Repeat:
+            k.miss[y] |= uint64_t(1) << x;
+            break;
+        }
+
+        for (const auto& cells : shot.sunkShips) {
+            int len = int(cells.size());
+            if (len > n || remaining[d][len] == 0) continue;
+            remaining[d][len]--;
+            shipsLeft[d]--;
+            for (auto& [cx, cy] : cells) {
+                uint64_t bit = uint64_t(1) << cx;
+                k.hit[cy] &= ~bit;
+                k.miss[cy] &= ~bit;
+                k.sunk[cy] |= bit;
+            }
+            k.remainingShips.erase(std::find(k.remainingShips.begin(), k.remainingShips.end(), len));
+        }
+
+        shooting[a]->shotResult(x, y, shot);
+        if (record) {
+            result.events.push_back({uint8_t(a), uint8_t(x), uint8_t(y), shot.kind,
+                                     uint8_t(shot.sunkShips.size())});
+        }
+    };
+
+    while (result.shots[0] + result.shots[1] < shotLimit) {
+        const int a = turn, d = 1 - turn;
+        result.turns++;
+
+        if (matchRules.salvo) {
+            // Клетки залпа выбираются по очереди; уже выбранные исключаются из выбора,
+            // но не из расстановок кораблей. Весь залп разбирается одним проходом
+            BoardKnowledge planning = knowledge[a];
+            std::vector<std::pair<int, int>> salvo;
+            const int k = std::min(rules::salvoSize(shipsLeft[a]), n * n - planning.knownCount());
+            for (int i = 0; i < k; ++i) {
+                auto [x, y] = shooting[a]->chooseShot(planning);
+                if (!rules::isInside(boards[d], x, y)) break;
+                salvo.emplace_back(x, y);
+                planning.excluded[y] |= uint64_t(1) << x;
+            }
+            if (salvo.empty()) break;
+
+            result.shots[a] += int(salvo.size());
+            std::vector<rules::ShotResult> shots = rules::resolveSalvo(boards[d], salvo);
+            for (size_t i = 0; i < salvo.size(); ++i) apply(a, d, salvo[i].first, salvo[i].second, shots[i]);
+            turn = d;
+        } else {
+            auto [x, y] = shooting[a]->chooseShot(knowledge[a]);
+            if (!rules::isInside(boards[d], x, y)) break;
+
+            result.shots[a]++;
+            rules::ShotResult shot = rules::resolveShot(boards[d], x, y);
+            apply(a, d, x, y, shot);
+            if (shot.kind != rules::ShotResult::Hit) turn = d;
+        }
+
+        if (shipsLeft[d] == 0) {
+            result.winner = a;
+            break;
+        }
+    }
+    return result;
+}
+
+void SelfPlayStats::merge(const SelfPlayStats& other) {
+    games += other.games;
+    unfinished += other.unfinished;
+    wins[0] += other.wins[0];
+    wins[1] += other.wins[1];
+    winnerShots += other.winnerShots;
+    turns += other.turns;
+    if (shotHistogram.size() < other.shotHistogram.size())
+        shotHistogram.resize(other.shotHistogram.size(), 0);
+    for (size_t i = 0; i < other.shotHistogram.size(); ++i)
+        shotHistogram[i] += other.shotHistogram[i];
+}
+
+double SelfPlayStats::averageShotsToWin() const {
+    size_t finished = games - unfinished;
+    return finished ? double(winnerShots) / finished : 0;
+}
+
+SelfPlayStats runSelfPlay(const SelfPlayConfig& config) {
+    const auto start = std::chrono::steady_clock::now();
+    const int cells = config.rules.gridSize * config.rules.gridSize;
+    const size_t chunk = 1024;
+
+    std::unique_ptr<RecordWriter> writer;
+    if (!config.recordPath.empty()) writer = std::make_unique<RecordWriter>(config.recordPath);
+    const bool record = writer != nullptr;
+
+    WorkStealingPool pool(config.threads);
+    std::vector<SelfPlayStats> perWorker(pool.size());
+    for (auto& s : perWorker) s.shotHistogram.assign(cells + 1, 0);
+
+    for (size_t begin = 0; begin < config.games; begin += chunk) {
+        size_t end = std::min(config.games, begin + chunk);
+        pool.submit([&, begin, end]() {
+            GameSimulator sim(config.rules, config.players[0], config.players[1]);
+            SelfPlayStats local;
+            local.shotHistogram.assign(cells + 1, 0);
+            GameRecordBuilder builder;
+            std::vector<uint8_t> records;
+
+            for (size_t i = begin; i < end; ++i) {
+                GameResult r = sim.play(gameSeed(config.seed, i), int(i & 1), record);
+                if (record) {
+                    builder.begin(config.rules.gridSize, config.rules.minesEnabled, r.firstPlayer, 0);
+                    builder.setBoard(0, r.boards[0]);
+                    builder.setBoard(1, r.boards[1]);
+                    for (const auto& e : r.events) builder.addShot(e);
+                    std::vector<uint8_t> bytes = builder.finish(r.winner);
+                    records.insert(records.end(), bytes.begin(), bytes.end());
+                }
+                local.games++;
+                local.turns += uint64_t(r.turns);
+                if (r.winner < 0) {
+                    local.unfinished++;
+                    continue;
+                }
+                int shots = r.shots[r.winner];
+                local.wins[r.winner]++;
+                local.winnerShots += shots;
+                local.shotHistogram[std::min(shots, cells)]++;
+            }
+            perWorker[WorkStealingPool::workerIndex()].merge(local);
+            if (record) writer->append(records);
+        });
+    }
+    pool.wait();
+
+    SelfPlayStats total;
+    for (const auto& s : perWorker) total.merge(s);
+    total.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return total;
+}
@@ -0,0 +1,110 @@
+// selfplay.h
+#ifndef SELFPLAY_H
+#define SELFPLAY_H
+
+#include "boardknowledge.h"
+#include "gamerules.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct MatchRules {
+    int gridSize = 10;
+    bool minesEnabled = false;
+    int minesCount = 2;
+    bool salvo = false;          // залпы: за ход по выстрелу на каждый свой корабль на плаву
+};
+
+// Стратегия расстановки флота на своём поле (мины уже стоят)
+class PlacementStrategy {
+public:
+    virtual ~PlacementStrategy() = default;
+    virtual void place(Grid& grid, const std::vector<int>& sizes, std::mt19937& rng) = 0;
+};
+
+// Стратегия стрельбы: видит только то, что знает о поле противника
+class ShootingStrategy {
+public:
+    virtual ~ShootingStrategy() = default;
+    virtual void newGame(const MatchRules& match, unsigned seed) = 0;
+    virtual std::pair<int, int> chooseShot(const BoardKnowledge& knowledge) = 0;
+    // Исход своего выстрела; знание о поле обновит симулятор, это - для внешних ботов
+    virtual void shotResult(int, int, const rules::ShotResult&) {}
+};
+
+// Имена стратегий: расстановка - classic, touching, edges;
+// стрельба - random, heatmap, exact (тепловая карта с точным эндшпилем), montecarlo.
+// И то и другое может делать внешний бот (botprotocol.h): "bot=команда" или
+// "bot=команда@мс" с ограничением времени на ход
+std::unique_ptr<PlacementStrategy> makePlacementStrategy(const std::string& name);
+std::unique_ptr<ShootingStrategy> makeShootingStrategy(const std::string& name);
+std::vector<std::string> placementStrategyNames();
+std::vector<std::string> shootingStrategyNames();
+
+struct PlayerSpec {
+    std::string placement = "classic";
+    std::string shooting = "heatmap";
+};
+
+struct GameResult {
+    int winner = -1;             // 0 или 1; -1 - партия не закончилась за отведённое число выстрелов
+    int firstPlayer = 0;
+    int shots[2] = {0, 0};
+    int turns = 0;               // ходов - сообщений с выстрелами в сетевой игре
+    Grid boards[2];              // начальные поля (корабли и мины), заполняются при recordBoards
+    std::vector<rules::ShotEvent> events;
+};
+
+// Однопоточная партия между двумя стратегиями по правилам rules::resolveShot.
+// Стрелявший узнаёт об исходе столько же, сколько из сетевого ответа (о мине - rules::mineBlastMask).
+// Ход переходит после промаха и мины, после попадания остаётся у стрелявшего;
+// в режиме залпов ход переходит после каждого залпа.
+class GameSimulator {
+public:
+    GameSimulator(const MatchRules& rules, const PlayerSpec& a, const PlayerSpec& b);
+
+    // Одинаковый seed - одинаковая партия
+    GameResult play(uint64_t seed, int firstPlayer, bool record = false);
+
+private:
+    MatchRules matchRules;
+    std::vector<int> sizes;
+    std::unique_ptr<PlacementStrategy> placement[2];
+    std::unique_ptr<ShootingStrategy> shooting[2];
+};
+
+struct SelfPlayConfig {
+    MatchRules rules;
+    PlayerSpec players[2];
+    size_t games = 100000;
+    unsigned threads = 0;        // 0 - по числу ядер
+    uint64_t seed = 1;
+    std::string recordPath;      // если задан, партии дописываются в архив (gamerecord.h)
+};
+
+struct SelfPlayStats {
+    size_t games = 0;
+    size_t unfinished = 0;
+    size_t wins[2] = {0, 0};
+    uint64_t winnerShots = 0;
+    uint64_t turns = 0;
+    std::vector<uint64_t> shotHistogram;  // число выстрелов победителя -> число партий
+    double seconds = 0;
+
+    void merge(const SelfPlayStats& other);
+    double gamesPerSecond() const { return seconds > 0 ? games / seconds : 0; }
+    double averageShotsToWin() const;
+    double averageTurns() const { return games ? double(turns) / games : 0; }
+};
+
+uint64_t gameSeed(uint64_t seed, uint64_t index);
+
+// Партии делятся на пачки в WorkStealingPool; сторона, ходящая первой, чередуется.
+// Результат не зависит от числа потоков.
+SelfPlayStats runSelfPlay(const SelfPlayConfig& config);
+
+#endif // SELFPLAY_H
@@ -0,0 +1,92 @@
+// Консольный прогон партий ИИ против ИИ без графики и сети:
+//   sea_selfplay --size 10 --games 1000000 --a classic:heatmap --b edges:random
+#include "selfplay.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+namespace {
+
+void printUsage() {
+    std::printf("usage: sea_selfplay [--size 8|10|12] [--games N] [--threads N] [--seed N]\n"
+                "                    [--mines N] [--a placement:shooting] [--b placement:shooting]\n"
+                "                    [--salvo on|off] [--histogram file.csv] [--record games.sea]\n");
+    std::printf("placement:");
+    for (const auto& name : placementStrategyNames()) std::printf(" %s", name.c_str());
+    std::printf("\nshooting:");
+    for (const auto& name : shootingStrategyNames()) std::printf(" %s", name.c_str());
+    std::printf("\neither may be an external bot: bot=<command>[@ms per move]\n");
+}
+
+bool parsePlayer(const std::string& value, PlayerSpec& spec) {
+    size_t colon = value.find(':');
+    if (colon == std::string::npos) return false;
+    spec.placement = value.substr(0, colon);
+    spec.shooting = value.substr(colon + 1);
+    return makePlacementStrategy(spec.placement) && makeShootingStrategy(spec.shooting);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    SelfPlayConfig config;
+    std::string histogramPath;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || i + 1 >= argc) {
+            printUsage();
+            return arg == "--help" ? 0 : 1;
+        }
+        std::string value = argv[++i];
+        if (arg == "--size") config.rules.gridSize = std::atoi(value.c_str());
+        else if (arg == "--games") config.games = std::strtoull(value.c_str(), nullptr, 10);
+        else if (arg == "--threads") config.threads = unsigned(std::atoi(value.c_str()));
+        else if (arg == "--seed") config.seed = std::strtoull(value.c_str(), nullptr, 10);
+        else if (arg == "--mines") {
+            config.rules.minesCount = std::atoi(value.c_str());
+            config.rules.minesEnabled = config.rules.minesCount > 0;
+        }
+        else if (arg == "--salvo" && (value == "on" || value == "off")) config.rules.salvo = value == "on";
+        else if (arg == "--histogram") histogramPath = value;
+        else if (arg == "--record") config.recordPath = value;
+        else if ((arg == "--a" || arg == "--b") && parsePlayer(value, config.players[arg == "--b"])) {}
+        else {
+            std::fprintf(stderr, "bad argument: %s %s\n", arg.c_str(), value.c_str());
+            printUsage();
+            return 1;
+        }
+    }
+
+    if (config.rules.gridSize != 8 && config.rules.gridSize != 10 && config.rules.gridSize != 12) {
+        std::fprintf(stderr, "size must be 8, 10 or 12\n");
+        return 1;
+    }
+
+    SelfPlayStats stats = runSelfPlay(config);
+
+    std::printf("games: %zu (unfinished %zu) in %.2f s - %.0f games/s, %.0f games/min\n",
+                stats.games, stats.unfinished, stats.seconds,
+                stats.gamesPerSecond(), stats.gamesPerSecond() * 60);
+    for (int p = 0; p < 2; ++p) {
+        std::printf("%c %s:%s wins %zu (%.1f%%)\n", p ? 'B' : 'A',
+                    config.players[p].placement.c_str(), config.players[p].shooting.c_str(),
+                    stats.wins[p], stats.games ? 100.0 * stats.wins[p] / stats.games : 0.0);
+    }
+    std::printf("average shots to win: %.2f, turns per game: %.2f\n", stats.averageShotsToWin(),
+                stats.averageTurns());
+
+    if (!histogramPath.empty()) {
+        std::ofstream out(histogramPath);
+        out << "shots,games\n";
+        for (size_t s = 0; s < stats.shotHistogram.size(); ++s)
+            if (stats.shotHistogram[s]) out << s << ',' << stats.shotHistogram[s] << '\n';
+    } else {
+        for (size_t s = 0; s < stats.shotHistogram.size(); ++s)
+            if (stats.shotHistogram[s]) std::printf("%3zu %llu\n", s,
+                                                    (unsigned long long)stats.shotHistogram[s]);
+    }
+    return 0;
+}
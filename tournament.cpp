@@ -0,0 +1,241 @@
+#include "tournament.h"
+#include "workstealingpool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace {
+
+struct BatchOutcome {
+    size_t wins = 0, losses = 0, draws = 0;
+};
+
+// Состояние пары: пачки могут завершаться в любом порядке, но в счёт идут
+// только подряд от первой, и после остановки остальные отбрасываются
+struct PairingState {
+    std::mutex mutex;
+    PairingResult result;
+    std::vector<BatchOutcome> outcomes;
+    std::vector<bool> done;
+    size_t counted = 0;
+    size_t nextBatch = 0;
+    bool stopped = false;
+    uint64_t seed = 0;
+};
+
+double eloFromScore(double s) {
+    s = std::clamp(s, 1e-4, 1 - 1e-4);
+    return -400 * std::log10(1 / s - 1);
+}
+
+bool shouldStop(const PairingResult& r, const TournamentConfig& config) {
+    if (r.games < config.minGames) return false;
+    double s = r.score();
+    double variance = (r.wins + 0.25 * r.draws) / r.games - s * s;
+    double se = std::sqrt(std::max(0.0, variance) / r.games);
+    return std::abs(s - 0.5) > config.stopZ * se;
+}
+
+// Брэдли-Терри методом MM; каждой паре добавляется одна виртуальная ничья,
+// чтобы участник без побед не уходил в минус бесконечность
+std::vector<double> bradleyTerryElo(size_t n, const std::vector<PairingResult>& pairings) {
+    std::vector<double> gamma(n, 1.0);
+    for (int iteration = 0; iteration < 1000; ++iteration) {
+        std::vector<double> wins(n, 0), denominator(n, 0);
+        for (const auto& p : pairings) {
+            if (!p.games) continue;
+            double games = p.games + 1.0;
+            double s = p.wins + 0.5 * p.draws + 0.5;
+            wins[p.first] += s;
+            wins[p.second] += games - s;
+            double d = games / (gamma[p.first] + gamma[p.second]);
+            denominator[p.first] += d;
+            denominator[p.second] += d;
+        }
+        double change = 0;
+        for (size_t i = 0; i < n; ++i) {
+            if (denominator[i] == 0) continue;
+            double g = wins[i] / denominator[i];
+            change = std::max(change, std::abs(g - gamma[i]) / gamma[i]);
+            gamma[i] = g;
+        }
+        if (change < 1e-9) break;
+    }
+
+    std::vector<double> elo(n);
+    double mean = 0;
+    for (size_t i = 0; i < n; ++i) mean += elo[i] = 400 * std::log10(gamma[i]);
+    mean /= n;
+    for (auto& e : elo) e += 1500 - mean;
+    return elo;
+}
+
+// Glicko-1: пачка с одним номером во всех парах - один рейтинговый период
+void glickoUpdate(std::vector<Rating>& ratings, const std::vector<PairingResult>& pairings,
+                  const std::vector<std::unique_ptr<PairingState>>& states) {
+    const double q = std::log(10.0) / 400;
+    const double pi = 3.14159265358979323846;
+    auto g = [&](double rd) { return 1 / std::sqrt(1 + 3 * q * q * rd * rd / (pi * pi)); };
+
+    size_t periods = 0;
+    for (const auto& s : states) periods = std::max(periods, s->counted);
+
+    const size_t n = ratings.size();
+    for (size_t period = 0; period < periods; ++period) {
+        std::vector<double> d2inv(n, 0), delta(n, 0);
+        for (size_t k = 0; k < pairings.size(); ++k) {
+            if (period >= states[k]->counted) continue;
+            const BatchOutcome& o = states[k]->outcomes[period];
+            double games = double(o.wins + o.losses + o.draws);
+            int a = pairings[k].first, b = pairings[k].second;
+            double sa = o.wins + 0.5 * o.draws;
+
+            for (int side = 0; side < 2; ++side) {
+                int self = side ? b : a, other = side ? a : b;
+                double gj = g(ratings[other].glickoRd);
+                double e = 1 / (1 + std::pow(10.0, -gj * (ratings[self].glicko - ratings[other].glicko) / 400));
+                double s = side ? games - sa : sa;
+                d2inv[self] += q * q * gj * gj * games * e * (1 - e);
+                delta[self] += gj * (s - games * e);
+            }
+        }
+        for (size_t i = 0; i < n; ++i) {
+            if (d2inv[i] == 0) continue;
+            Rating& r = ratings[i];
+            double rd2 = 1 / (1 / (r.glickoRd * r.glickoRd) + d2inv[i]);
+            r.glicko += q * rd2 * delta[i];
+            r.glickoRd = std::sqrt(rd2);
+        }
+    }
+}
+
+} // namespace
+
+double PairingResult::margin() const {
+    if (!games) return 0.5;
+    double s = score();
+    double variance = std::max(0.0, (wins + 0.25 * draws) / games - s * s);
+    return 1.96 * std::sqrt(variance / games);
+}
+
+double PairingResult::eloDiff() const {
+    return eloFromScore(score());
+}
+
+double PairingResult::eloMargin() const {
+    double s = score(), m = margin();
+    return (eloFromScore(s + m) - eloFromScore(s - m)) / 2;
+}
+
+double TournamentResult::matrixScore(int row, int column) const {
+    if (row == column) return -1;
+    for (const auto& p : pairings) {
+        if (p.first == row && p.second == column) return p.score();
+        if (p.first == column && p.second == row) return 1 - p.score();
+    }
+    return -1;
+}
+
+std::string participantName(const PlayerSpec& spec) {
+    return spec.placement + ":" + spec.shooting;
+}
+
+TournamentResult runTournament(const TournamentConfig& config) {
+    const auto start = std::chrono::steady_clock::now();
+    const size_t n = config.participants.size();
+    const size_t batch = std::max<size_t>(2, config.batchGames & ~size_t(1));
+    const size_t maxBatches = (config.maxGames + batch - 1) / batch;
+
+    TournamentResult result;
+    for (const auto& p : config.participants) result.names.push_back(participantName(p));
+
+    std::vector<std::unique_ptr<PairingState>> states;
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = i + 1; j < n; ++j) {
+            auto state = std::make_unique<PairingState>();
+            state->result.first = int(i);
+            state->result.second = int(j);
+            state->outcomes.resize(maxBatches);
+            state->done.assign(maxBatches, false);
+            state->seed = gameSeed(config.seed, i * n + j);
+            states.push_back(std::move(state));
+        }
+    }
+
+    WorkStealingPool pool(config.threads);
+    std::function<void(size_t, size_t)> runBatch = [&](size_t k, size_t b) {
+        PairingState& state = *states[k];
+        const PlayerSpec& a = config.participants[state.result.first];
+        const PlayerSpec& c = config.participants[state.result.second];
+        GameSimulator direct(config.rules, a, c);
+        GameSimulator swapped(config.rules, c, a);
+
+        // Чётная партия: first играет стороной 0 и ходит первым, нечётная - наоборот,
+        // на тех же случайных числах. Последняя пачка обрезается по maxGames
+        BatchOutcome outcome;
+        const size_t end = std::min((b + 1) * batch, config.maxGames);
+        for (size_t game = b * batch; game < end; ++game) {
+            uint64_t seed = gameSeed(state.seed, game / 2);
+            bool swap = game & 1;
+            GameResult r = swap ? swapped.play(seed, 0) : direct.play(seed, 0);
+            if (r.winner < 0) outcome.draws++;
+            else if ((r.winner == 0) != swap) outcome.wins++;
+            else outcome.losses++;
+        }
+
+        size_t next = maxBatches;
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            state.outcomes[b] = outcome;
+            state.done[b] = true;
+            while (!state.stopped && state.counted < maxBatches && state.done[state.counted]) {
+                const BatchOutcome& o = state.outcomes[state.counted++];
+                state.result.games += o.wins + o.losses + o.draws;
+                state.result.wins += o.wins;
+                state.result.losses += o.losses;
+                state.result.draws += o.draws;
+                if (shouldStop(state.result, config)) {
+                    state.stopped = true;
+                    state.result.decided = true;
+                }
+            }
+            if (!state.stopped && state.nextBatch < maxBatches) next = state.nextBatch++;
+        }
+        if (next < maxBatches) pool.submit([&runBatch, k, next]() { runBatch(k, next); });
+    };
+
+    // Несколько пачек каждой пары в работе одновременно, чтобы занять все потоки
+    const size_t inflight = states.empty() ? 0
+        : std::max<size_t>(2, (2 * pool.size() + states.size() - 1) / states.size());
+    for (size_t k = 0; k < states.size(); ++k) {
+        PairingState& state = *states[k];
+        while (state.nextBatch < std::min(inflight, maxBatches)) {
+            size_t b = state.nextBatch++;
+            pool.submit([&runBatch, k, b]() { runBatch(k, b); });
+        }
+    }
+    pool.wait();
+
+    for (const auto& s : states) result.pairings.push_back(s->result);
+
+    result.ratings.assign(n, Rating());
+    std::vector<double> elo = bradleyTerryElo(n, result.pairings);
+    std::vector<double> points(n, 0);
+    for (const auto& p : result.pairings) {
+        points[p.first] += p.wins + 0.5 * p.draws;
+        points[p.second] += p.losses + 0.5 * p.draws;
+        result.ratings[p.first].games += p.games;
+        result.ratings[p.second].games += p.games;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        result.ratings[i].elo = elo[i];
+        if (result.ratings[i].games) result.ratings[i].score = points[i] / result.ratings[i].games;
+    }
+    glickoUpdate(result.ratings, result.pairings, states);
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
@@ -0,0 +1,63 @@
+// tournament.h
+#ifndef TOURNAMENT_H
+#define TOURNAMENT_H
+
+#include "selfplay.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct TournamentConfig {
+    MatchRules rules;
+    std::vector<PlayerSpec> participants;
+    size_t maxGames = 2000;      // партий на пару самое большее
+    size_t minGames = 200;       // раньше этого пара не останавливается
+    size_t batchGames = 64;      // партий в одной задаче пула, чётное число
+    double stopZ = 3.0;          // порог досрочной остановки в стандартных ошибках
+    unsigned threads = 0;        // 0 - по числу ядер
+    uint64_t seed = 1;
+};
+
+// Итог пары участников; счёт - с точки зрения first
+struct PairingResult {
+    int first = 0, second = 0;
+    size_t games = 0;
+    size_t wins = 0, losses = 0, draws = 0;  // ничья - партия, не закончившаяся за лимит выстрелов
+    bool decided = false;                    // остановлена досрочно: счёт надёжно отличается от 50%
+
+    double score() const { return games ? (wins + 0.5 * draws) / games : 0.5; }
+    // Половина 95% доверительного интервала счёта
+    double margin() const;
+    // Разница Elo, соответствующая счёту, и её 95% интервал
+    double eloDiff() const;
+    double eloMargin() const;
+};
+
+struct Rating {
+    double elo = 1500;           // Брэдли-Терри по всем партиям, среднее - 1500
+    double glicko = 1500;
+    double glickoRd = 350;       // отклонение Glicko; 95% интервал - glicko +- 1.96 * glickoRd
+    double score = 0;            // средний счёт по всем партиям
+    size_t games = 0;
+};
+
+struct TournamentResult {
+    std::vector<std::string> names;
+    std::vector<PairingResult> pairings;
+    std::vector<Rating> ratings;
+    double seconds = 0;
+
+    // Счёт row против column, -1 на диагонали
+    double matrixScore(int row, int column) const;
+};
+
+std::string participantName(const PlayerSpec& spec);
+
+// Круговой турнир: каждая пара играет пачками партий в WorkStealingPool.
+// В каждой паре партий с одним seed участники меняются сторонами и правом
+// первого хода. Решение об остановке принимается по пачкам в порядке номеров,
+// поэтому результат не зависит от числа потоков.
+TournamentResult runTournament(const TournamentConfig& config);
+
+#endif // TOURNAMENT_H
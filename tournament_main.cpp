@@ -0,0 +1,138 @@
+// Круговой турнир стратегий расстановки и стрельбы:
+//   sea_tournament --games 4000 --player classic:heatmap --player edges:random --player classic:exact
+#include "tournament.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <numeric>
+#include <string>
+
+namespace {
+
+void printUsage() {
+    std::printf("usage: sea_tournament [--size 8|10|12] [--mines N] [--games N] [--min-games N]\n"
+                "                      [--z Z] [--threads N] [--seed N] [--csv matrix.csv]\n"
+                "                      --player placement:shooting [--player ...]\n");
+    std::printf("placement:");
+    for (const auto& name : placementStrategyNames()) std::printf(" %s", name.c_str());
+    std::printf("\nshooting:");
+    for (const auto& name : shootingStrategyNames()) std::printf(" %s", name.c_str());
+    std::printf("\neither may be an external bot: bot=<command>[@ms per move]\n");
+}
+
+bool parsePlayer(const std::string& value, PlayerSpec& spec) {
+    size_t colon = value.find(':');
+    if (colon == std::string::npos) return false;
+    spec.placement = value.substr(0, colon);
+    spec.shooting = value.substr(colon + 1);
+    return makePlacementStrategy(spec.placement) && makeShootingStrategy(spec.shooting);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    TournamentConfig config;
+    std::string csvPath;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || i + 1 >= argc) {
+            printUsage();
+            return arg == "--help" ? 0 : 1;
+        }
+        std::string value = argv[++i];
+        PlayerSpec spec;
+        if (arg == "--size") config.rules.gridSize = std::atoi(value.c_str());
+        else if (arg == "--games") config.maxGames = std::strtoull(value.c_str(), nullptr, 10);
+        else if (arg == "--min-games") config.minGames = std::strtoull(value.c_str(), nullptr, 10);
+        else if (arg == "--z") config.stopZ = std::atof(value.c_str());
+        else if (arg == "--threads") config.threads = unsigned(std::atoi(value.c_str()));
+        else if (arg == "--seed") config.seed = std::strtoull(value.c_str(), nullptr, 10);
+        else if (arg == "--mines") {
+            config.rules.minesCount = std::atoi(value.c_str());
+            config.rules.minesEnabled = config.rules.minesCount > 0;
+        }
+        else if (arg == "--csv") csvPath = value;
+        else if (arg == "--player" && parsePlayer(value, spec)) config.participants.push_back(spec);
+        else {
+            std::fprintf(stderr, "bad argument: %s %s\n", arg.c_str(), value.c_str());
+            printUsage();
+            return 1;
+        }
+    }
+
+    if (config.rules.gridSize != 8 && config.rules.gridSize != 10 && config.rules.gridSize != 12) {
+        std::fprintf(stderr, "size must be 8, 10 or 12\n");
+        return 1;
+    }
+    if (config.participants.empty()) {
+        for (const char *name : {"classic:random", "classic:heatmap", "edges:heatmap", "classic:exact"}) {
+            PlayerSpec spec;
+            parsePlayer(name, spec);
+            config.participants.push_back(spec);
+        }
+    }
+    if (config.participants.size() < 2) {
+        std::fprintf(stderr, "need at least two players\n");
+        return 1;
+    }
+
+    TournamentResult result = runTournament(config);
+    const int n = int(result.names.size());
+    size_t totalGames = 0;
+    for (const auto& p : result.pairings) totalGames += p.games;
+    std::printf("%zu games in %.2f s\n\n", totalGames, result.seconds);
+
+    std::vector<int> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+        return result.ratings[a].elo > result.ratings[b].elo;
+    });
+
+    std::printf("%-3s %-24s %7s %7s %6s %7s %7s\n", "#", "player", "elo", "glicko", "+-", "score", "games");
+    for (int rank = 0; rank < n; ++rank) {
+        const Rating& r = result.ratings[order[rank]];
+        std::printf("%-3d %-24s %7.0f %7.0f %6.0f %6.1f%% %7zu\n", rank + 1,
+                    result.names[order[rank]].c_str(), r.elo, r.glicko, 1.96 * r.glickoRd,
+                    100 * r.score, r.games);
+    }
+
+    std::printf("\nscore of row against column, %%\n%-24s", "");
+    for (int c = 0; c < n; ++c) std::printf(" %6d", c + 1);
+    std::printf("\n");
+    for (int row : order) {
+        std::printf("%-24s", result.names[row].c_str());
+        for (int column : order) {
+            double s = result.matrixScore(row, column);
+            if (s < 0) std::printf(" %6s", "-");
+            else std::printf(" %6.1f", 100 * s);
+        }
+        std::printf("\n");
+    }
+
+    std::printf("\n");
+    for (const auto& p : result.pairings) {
+        std::printf("%s vs %s: %.1f%% +- %.1f, Elo %+.0f +- %.0f, %zu games (+%zu -%zu =%zu)%s\n",
+                    result.names[p.first].c_str(), result.names[p.second].c_str(),
+                    100 * p.score(), 100 * p.margin(), p.eloDiff(), p.eloMargin(),
+                    p.games, p.wins, p.losses, p.draws, p.decided ? ", decided" : "");
+    }
+
+    if (!csvPath.empty()) {
+        std::ofstream out(csvPath);
+        out << "player";
+        for (int c = 0; c < n; ++c) out << ',' << result.names[c];
+        out << '\n';
+        for (int row = 0; row < n; ++row) {
+            out << result.names[row];
+            for (int column = 0; column < n; ++column) {
+                double s = result.matrixScore(row, column);
+                out << ',';
+                if (s >= 0) out << s;
+            }
+            out << '\n';
+        }
+    }
+    return 0;
+}
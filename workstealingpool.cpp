@@ -0,0 +1,90 @@
+#include "workstealingpool.h"
+#include <algorithm>
+
+namespace {
+thread_local int currentWorker = -1;
+thread_local const WorkStealingPool *currentPool = nullptr;
+}
+
+WorkStealingPool::WorkStealingPool(unsigned threads) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned i = 0; i < threads; ++i) queues.push_back(std::make_unique<Queue>());
+    for (unsigned i = 0; i < threads; ++i) workers.emplace_back(&WorkStealingPool::run, this, i);
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& t : workers) t.join();
+}
+
+int WorkStealingPool::workerIndex() {
+    return currentWorker;
+}
+
+void WorkStealingPool::submit(std::function<void()> task) {
+    // Задачи из самого пула кладутся в свою очередь, внешние - по кругу
+    unsigned target = currentPool == this ? unsigned(currentWorker)
+                                         : nextQueue.fetch_add(1) % size();
+    pending.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        queued.fetch_add(1);
+    }
+    {
+        std::lock_guard<std::mutex> lock(queues[target]->mutex);
+        queues[target]->tasks.push_back(std::move(task));
+    }
+    wake.notify_one();
+}
+
+void WorkStealingPool::wait() {
+    std::unique_lock<std::mutex> lock(sleepMutex);
+    idle.wait(lock, [this] { return pending.load() == 0; });
+}
+
+bool WorkStealingPool::takeTask(unsigned self, std::function<void()>& task) {
+    {
+        Queue& own = *queues[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.front());
+            own.tasks.pop_front();
+            return true;
+        }
+    }
+    for (unsigned i = 1; i < size(); ++i) {
+        Queue& victim = *queues[(self + i) % size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.back());
+            victim.tasks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::run(unsigned self) {
+    currentWorker = int(self);
+    currentPool = this;
+    for (;;) {
+        std::function<void()> task;
+        if (takeTask(self, task)) {
+            queued.fetch_sub(1);
+            task();
+            if (pending.fetch_sub(1) == 1) {
+                std::lock_guard<std::mutex> lock(sleepMutex);
+                idle.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wake.wait(lock, [this] { return stopping || queued.load() > 0; });
+        if (stopping && queued.load() == 0) return;
+    }
+}
@@ -0,0 +1,53 @@
+// workstealingpool.h
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Пул потоков с собственной очередью у каждого потока. Свободный поток берёт
+// задачи из начала своей очереди, а когда она пуста - крадёт с конца чужих.
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(unsigned threads = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    unsigned size() const { return unsigned(workers.size()); }
+    void submit(std::function<void()> task);
+    // Ждёт завершения всех отправленных задач
+    void wait();
+
+    // Номер потока пула, на котором выполняется задача; -1 вне пула
+    static int workerIndex();
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<unsigned> nextQueue{0};
+    std::atomic<size_t> queued{0};
+    std::atomic<size_t> pending{0};
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    bool stopping = false;
+
+    bool takeTask(unsigned self, std::function<void()>& task);
+    void run(unsigned self);
+};
+
+#endif // WORKSTEALINGPOOL_H